@@ -0,0 +1,149 @@
+#include "benchmarks.h"
+#include "HashedStringHash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HASHING_NUM_STRINGS 4096
+#define HASHING_NUM_PASSES 200
+#define HASHING_MAX_LENGTH 256
+
+// Length classes reported separately, upper bounds inclusive
+static const uint32_t HashingLengthClasses[] = { 16, 32, 64, 128, HASHING_MAX_LENGTH };
+#define HASHING_NUM_LENGTH_CLASSES (sizeof(HashingLengthClasses) / sizeof(HashingLengthClasses[0]))
+
+typedef struct HashingString HashingString_t;
+struct HashingString
+{
+  char* String;
+  // Including terminator, same as HashedString_Create hashes
+  size_t Length;
+};
+
+// Tag-like lengths: mostly short hierarchical names, a tail of long ones
+static size_t Hashing_PickLength(uint32_t* rng)
+{
+  const uint32_t roll = Bench_Random(rng) % 100;
+  if (roll < 60)
+  {
+    return 8 + Bench_Random(rng) % 17; // 8-24
+  }
+  if (roll < 90)
+  {
+    return 25 + Bench_Random(rng) % 24; // 25-48
+  }
+  if (roll < 98)
+  {
+    return 49 + Bench_Random(rng) % 48; // 49-96
+  }
+  return 97 + Bench_Random(rng) % (HASHING_MAX_LENGTH - 97); // 97-255
+}
+
+static uint32_t Hashing_GetLengthClass(size_t length)
+{
+  for (uint32_t l = 0; l < HASHING_NUM_LENGTH_CLASSES; ++l)
+  {
+    if (length <= HashingLengthClasses[l])
+    {
+      return l;
+    }
+  }
+  return HASHING_NUM_LENGTH_CLASSES - 1;
+}
+
+static int Hashing_CompareLengthClass(const void* lhs, const void* rhs)
+{
+  const uint32_t lhsClass = Hashing_GetLengthClass(((const HashingString_t*)lhs)->Length);
+  const uint32_t rhsClass = Hashing_GetLengthClass(((const HashingString_t*)rhs)->Length);
+  return (lhsClass > rhsClass) - (lhsClass < rhsClass);
+}
+
+// Generates the strings grouped by length class, outClassStart[l] is the index of the first string in class l
+static void Hashing_MakeStrings(HashingString_t* strings, uint32_t* outClassStart)
+{
+  uint32_t rng = 0xC0FFEEu;
+  for (uint32_t s = 0; s < HASHING_NUM_STRINGS; ++s)
+  {
+    const size_t length = Hashing_PickLength(&rng);
+    char* string = (char*)malloc(length + 1);
+    for (size_t c = 0; c < length; ++c)
+    {
+      // Words of a-z separated by dots, like A.B.C tags
+      string[c] = (c > 0 && Bench_Random(&rng) % 8 == 0) ? '.' : (char)('a' + Bench_Random(&rng) % 26);
+    }
+    string[length] = '\0';
+    strings[s].String = string;
+    strings[s].Length = length + 1;
+  }
+
+  // Group by class so each class can be timed with a tight loop
+  qsort(strings, HASHING_NUM_STRINGS, sizeof(HashingString_t), Hashing_CompareLengthClass);
+  uint32_t s = 0;
+  for (uint32_t l = 0; l <= HASHING_NUM_LENGTH_CLASSES; ++l)
+  {
+    while (s < HASHING_NUM_STRINGS && Hashing_GetLengthClass(strings[s].Length) < l)
+    {
+      s++;
+    }
+    outClassStart[l] = s;
+  }
+}
+
+void Bench_Hashing(void)
+{
+  HashingString_t* strings = (HashingString_t*)malloc(HASHING_NUM_STRINGS * sizeof(HashingString_t));
+  uint32_t classStart[HASHING_NUM_LENGTH_CLASSES + 1];
+  Hashing_MakeStrings(strings, classStart);
+
+  uint32_t numBackends = 0;
+  const HashedStringHashBackend_t* backends = HashedStringHash_GetBackends(&numBackends);
+  const uint64_t seed = 0x9E3779B97F4A7C15ull;
+
+  printf("Hashing: %d strings, %d passes, best backend %s\n", HASHING_NUM_STRINGS, HASHING_NUM_PASSES, HashedStringHash_GetBestBackend()->Name);
+  printf("  %-14s %10s", "backend", "all");
+  for (uint32_t l = 0; l < HASHING_NUM_LENGTH_CLASSES; ++l)
+  {
+    char header[16];
+    snprintf(header, sizeof(header), "<=%u", HashingLengthClasses[l]);
+    printf(" %10s", header);
+  }
+  printf("   (ns/hash)\n");
+
+  for (uint32_t b = 0; b < numBackends; ++b)
+  {
+    const HashedStringHashBackend_t* backend = &backends[b];
+    uint64_t classNs[HASHING_NUM_LENGTH_CLASSES] = { 0 };
+    uint64_t totalNs = 0;
+    uint64_t checksum = 0;
+
+    // Time per length class so the short strings, which dominate, aren't hidden by the long ones
+    for (uint32_t l = 0; l < HASHING_NUM_LENGTH_CLASSES; ++l)
+    {
+      const uint64_t start = Bench_NowNs();
+      for (uint32_t pass = 0; pass < HASHING_NUM_PASSES; ++pass)
+      {
+        for (uint32_t s = classStart[l]; s < classStart[l + 1]; ++s)
+        {
+          checksum += hsHash_Fold(HashedStringHash_Hash(backend, strings[s].String, strings[s].Length, seed));
+        }
+      }
+      classNs[l] = Bench_NowNs() - start;
+      totalNs += classNs[l];
+    }
+
+    printf("  %-14s %10.2f", backend->Name, (double)totalNs / ((double)HASHING_NUM_STRINGS * HASHING_NUM_PASSES));
+    for (uint32_t l = 0; l < HASHING_NUM_LENGTH_CLASSES; ++l)
+    {
+      const uint32_t classCount = classStart[l + 1] - classStart[l];
+      printf(" %10.2f", classCount ? (double)classNs[l] / ((double)classCount * HASHING_NUM_PASSES) : 0.0);
+    }
+    // Every kernel of an algorithm must agree, a differing checksum means a broken kernel
+    printf("   checksum %016llx\n", (unsigned long long)checksum);
+  }
+
+  for (uint32_t s = 0; s < HASHING_NUM_STRINGS; ++s)
+  {
+    free(strings[s].String);
+  }
+  free(strings);
+}
@@ -0,0 +1,9 @@
+#include "benchmarks.h"
+
+int main(int argc, const char** argv)
+{
+  Bench_Hashing();
+  Bench_TagChanges();
+
+  return 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#ifndef HTAGS_BENCHMARKS_H
+#define HTAGS_BENCHMARKS_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Monotonic-enough wall clock in nanoseconds, C17 only so it builds everywhere the library does
+static inline uint64_t Bench_NowNs(void)
+{
+  struct timespec now;
+  timespec_get(&now, TIME_UTC);
+  return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// Small deterministic PRNG (xorshift32) so runs are comparable
+static inline uint32_t Bench_Random(uint32_t* state)
+{
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+// Polling vs event-driven handling of tag container changes
+void Bench_TagChanges(void);
+// Hash backend throughput over a tag-like string length distribution
+void Bench_Hashing(void);
+
+#endif // HTAGS_BENCHMARKS_H
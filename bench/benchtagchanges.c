@@ -0,0 +1,168 @@
+#include "benchmarks.h"
+#include "HierarchicalTagContainer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define TAGCHANGES_NUM_CONTAINERS 10000
+#define TAGCHANGES_NUM_TICKS 1000
+#define TAGCHANGES_CHANGES_PER_TICK 50
+
+typedef struct TagChangesContext TagChangesContext_t;
+struct TagChangesContext
+{
+  HierarchicalTagContainer_t* Containers;
+  HTag BaseTags[3];
+  HTag StatusTags[2];
+  HTag StatusParent;
+
+  // Indices of containers changed this tick, for the dirty-list variant
+  uint32_t* DirtyList;
+  uint32_t NumDirty;
+};
+
+static void TagChanges_Setup(TagChangesContext_t* context)
+{
+  context->Containers = (HierarchicalTagContainer_t*)malloc(TAGCHANGES_NUM_CONTAINERS * sizeof(HierarchicalTagContainer_t));
+  context->DirtyList = (uint32_t*)malloc(TAGCHANGES_NUM_CONTAINERS * sizeof(uint32_t));
+  context->NumDirty = 0;
+  for (uint32_t c = 0; c < TAGCHANGES_NUM_CONTAINERS; ++c)
+  {
+    HierarchicalTagContainer_Init(&context->Containers[c], NULL);
+    for (uint32_t t = 0; t < 3; ++t)
+    {
+      HierarchicalTagContainer_AddTag(&context->Containers[c], &context->BaseTags[t]);
+    }
+    // Start clean, initial tags aren't interesting changes
+    HierarchicalTagContainer_ClearChanges(&context->Containers[c]);
+  }
+}
+
+static void TagChanges_Teardown(TagChangesContext_t* context)
+{
+  for (uint32_t c = 0; c < TAGCHANGES_NUM_CONTAINERS; ++c)
+  {
+    HierarchicalTagContainer_Cleanup(&context->Containers[c]);
+  }
+  free(context->Containers);
+  free(context->DirtyList);
+}
+
+// Gameplay side, toggles a status tag on a few random containers
+static void TagChanges_Mutate(TagChangesContext_t* context, uint32_t* rng)
+{
+  for (uint32_t i = 0; i < TAGCHANGES_CHANGES_PER_TICK; ++i)
+  {
+    const uint32_t c = Bench_Random(rng) % TAGCHANGES_NUM_CONTAINERS;
+    const HTag* statusTag = &context->StatusTags[Bench_Random(rng) % 2];
+    HierarchicalTagContainer_t* container = &context->Containers[c];
+
+    const bool bWasDirty = HierarchicalTagContainer_IsDirty(container);
+    if (!HierarchicalTagContainer_AddTag(container, statusTag))
+    {
+      HierarchicalTagContainer_RemoveTag(container, statusTag);
+    }
+    if (!bWasDirty && HierarchicalTagContainer_IsDirty(container))
+    {
+      context->DirtyList[context->NumDirty++] = c;
+    }
+  }
+}
+
+static void TagChanges_OnStatusChanged(
+  void* userData,
+  const HierarchicalTagContainer_t* container,
+  const HierarchicalTag_t* addedTags, uint32_t numAdded,
+  const HierarchicalTag_t* removedTags, uint32_t numRemoved
+)
+{
+  uint64_t* numTransitions = (uint64_t*)userData;
+  *numTransitions += numAdded + numRemoved;
+}
+
+typedef enum TagChangesMode TagChangesMode;
+enum TagChangesMode
+{
+  TCM_Polling,
+  TCM_EventsScanDirty,
+  TCM_EventsDirtyList
+};
+
+static void TagChanges_Run(TagChangesContext_t* context, TagChangesMode mode, const char* name)
+{
+  TagChanges_Setup(context);
+
+  // Polling keeps its own copy of last tick's state to diff against
+  bool* previousState = (bool*)calloc(TAGCHANGES_NUM_CONTAINERS * 2, sizeof(bool));
+  uint64_t numTransitions = 0;
+
+  HierarchicalTagEventDispatcher_t dispatcher;
+  HierarchicalTagEventDispatcher_Init(&dispatcher, NULL);
+  HierarchicalTagEventDispatcher_Subscribe(&dispatcher, &context->StatusParent, true, TagChanges_OnStatusChanged, &numTransitions);
+
+  uint32_t rng = 0x12345678u;
+  uint64_t systemNs = 0;
+  for (uint32_t tick = 0; tick < TAGCHANGES_NUM_TICKS; ++tick)
+  {
+    TagChanges_Mutate(context, &rng);
+
+    // Only time the system reacting to changes
+    const uint64_t start = Bench_NowNs();
+    switch (mode)
+    {
+    case TCM_Polling:
+      for (uint32_t c = 0; c < TAGCHANGES_NUM_CONTAINERS; ++c)
+      {
+        for (uint32_t s = 0; s < 2; ++s)
+        {
+          const bool bHasStatus = HierarchicalTagContainer_HasTag(&context->Containers[c], &context->StatusTags[s]);
+          if (bHasStatus != previousState[c * 2 + s])
+          {
+            previousState[c * 2 + s] = bHasStatus;
+            numTransitions++;
+          }
+        }
+        // Nobody consumes the deltas when polling, keep them from piling up
+        HierarchicalTagContainer_ClearChanges(&context->Containers[c]);
+      }
+      break;
+    case TCM_EventsScanDirty:
+      for (uint32_t c = 0; c < TAGCHANGES_NUM_CONTAINERS; ++c)
+      {
+        HierarchicalTagEventDispatcher_Flush(&dispatcher, &context->Containers[c]);
+      }
+      break;
+    case TCM_EventsDirtyList:
+      for (uint32_t d = 0; d < context->NumDirty; ++d)
+      {
+        HierarchicalTagEventDispatcher_Flush(&dispatcher, &context->Containers[context->DirtyList[d]]);
+      }
+      break;
+    }
+    systemNs += Bench_NowNs() - start;
+    context->NumDirty = 0;
+  }
+
+  printf("  %-22s %10.1f us/tick, %llu transitions\n", name, (double)systemNs / TAGCHANGES_NUM_TICKS / 1000.0, (unsigned long long)numTransitions);
+
+  HierarchicalTagEventDispatcher_Cleanup(&dispatcher);
+  free(previousState);
+  TagChanges_Teardown(context);
+}
+
+void Bench_TagChanges(void)
+{
+  TagChangesContext_t context;
+  context.BaseTags[0] = HierarchicalTag_Create("Team.Red");
+  context.BaseTags[1] = HierarchicalTag_Create("Class.Warrior");
+  context.BaseTags[2] = HierarchicalTag_Create("Ability.Fireball");
+  context.StatusTags[0] = HierarchicalTag_Create("Status.Stunned");
+  context.StatusTags[1] = HierarchicalTag_Create("Status.Burning");
+  context.StatusParent = HierarchicalTag_Create("Status");
+
+  printf("Tag changes: %d containers, %d ticks, %d changes per tick\n", TAGCHANGES_NUM_CONTAINERS, TAGCHANGES_NUM_TICKS, TAGCHANGES_CHANGES_PER_TICK);
+  TagChanges_Run(&context, TCM_Polling, "polling");
+  TagChanges_Run(&context, TCM_EventsScanDirty, "events (scan dirty)");
+  TagChanges_Run(&context, TCM_EventsDirtyList, "events (dirty list)");
+}
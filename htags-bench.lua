@@ -0,0 +1,22 @@
+include "htags-common.lua"
+
+project "hierarchical-tags-bench"
+        kind "ConsoleApp"
+        language "C"
+        cdialect "C17"
+        exceptionhandling (EXCEPTIONS_ENABLED)
+        rtti "Off"
+        staticruntime (STATIC_RUNTIME)
+        files
+        {
+            path.join(BENCH_DIR, "*.c"),
+            path.join(BENCH_DIR, "*.h")
+        }
+        includedirs
+        {
+            (INCLUDE_DIR)
+        }
+        links { "hierarchical-tags-lib" }
+        filter "system:linux"
+            links { "pthread", "rt" }
+        filter {}
@@ -19,3 +19,4 @@ end
 SRC_DIR = "src/"
 INCLUDE_DIR = "include/"
 TESTS_DIR = "tests/"
+BENCH_DIR = "bench/"
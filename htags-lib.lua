@@ -19,6 +19,19 @@ project "hierarchical-tags-lib"
             "xxHash"
         }
         links { "cityhash-c", "libxxhash" }
+        -- Shared registry needs shm_open and process-shared mutexes
+        filter "system:linux"
+            links { "pthread", "rt" }
+        -- XXH3 kernels are each built for their own instruction set, HashedStringHash.c picks one at runtime
+        filter { "files:**HashedStringHash_AVX2.c", "toolset:not msc*" }
+            buildoptions { "-mavx2" }
+        filter { "files:**HashedStringHash_AVX2.c", "toolset:msc*" }
+            buildoptions { "/arch:AVX2" }
+        filter { "files:**HashedStringHash_AVX512.c", "toolset:not msc*" }
+            buildoptions { "-mavx512f" }
+        filter { "files:**HashedStringHash_AVX512.c", "toolset:msc*" }
+            buildoptions { "/arch:AVX512" }
+        filter {}
 
 include "cityhash/cityhash-clib.lua"
 include "xxHash/premake_unofficial/xxhash.lua"
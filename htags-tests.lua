@@ -17,4 +17,8 @@ project "hierarchical-tags-tests"
             (INCLUDE_DIR)
         }
         links { "hierarchical-tags-lib" }
+        -- Shared registry needs shm_open and process-shared mutexes
+        filter "system:linux"
+            links { "pthread", "rt" }
+        filter {}
 
@@ -8,12 +8,57 @@
 #define HASHEDSTRING_ALLOW_CASE_INSENSITIVE 1
 #endif // HASHEDSTRING_ALLOW_CASE_INSENSITIVE
 
-#ifndef HASHEDSTRING_USE_32BIT
+#if defined(HASHEDSTRING_USE_128BIT) && defined(HASHEDSTRING_USE_32BIT)
+#error "HASHEDSTRING_USE_128BIT and HASHEDSTRING_USE_32BIT are mutually exclusive"
+#endif
+#if defined(HASHEDSTRING_USE_128BIT) && defined(HASHEDSTRING_USE_CITYHASH)
+#error "HASHEDSTRING_USE_128BIT is only supported with xxHash (XXH3_128bits)"
+#endif
+
+#if defined(HASHEDSTRING_USE_128BIT)
+typedef struct hsHash128 hsHash_t;
+struct hsHash128
+{
+  uint64_t Low64;
+  uint64_t High64;
+};
+#elif !defined(HASHEDSTRING_USE_32BIT)
 typedef uint64_t hsHash_t;
 #else
 typedef uint32_t hsHash_t;
 #endif
 
+// Hash helpers, so code doesn't need to care whether hsHash_t is an integer or a struct
+static inline bool hsHash_Equal(const hsHash_t lhs, const hsHash_t rhs)
+{
+#if defined(HASHEDSTRING_USE_128BIT)
+  return lhs.Low64 == rhs.Low64 && lhs.High64 == rhs.High64;
+#else
+  return lhs == rhs;
+#endif
+}
+
+// Fold down to an integer suitable for picking a bucket
+static inline uint64_t hsHash_Fold(const hsHash_t hash)
+{
+#if defined(HASHEDSTRING_USE_128BIT)
+  return hash.Low64;
+#else
+  return (uint64_t)hash;
+#endif
+}
+
+// Hash of invalid HashedStrings (created from NULL, or the string couldn't be stored), never given to a real string
+static inline hsHash_t hsHash_Null(void)
+{
+#if defined(HASHEDSTRING_USE_128BIT)
+  const hsHash_t nullHash = { 0, 0 };
+  return nullHash;
+#else
+  return 0;
+#endif
+}
+
 typedef enum HashedStringCaseSensitivity HashedStringCaseSensitivity;
 enum HashedStringCaseSensitivity
 {
@@ -40,13 +85,27 @@ struct HashedString
 #endif // HASHEDSTRING_ALLOW_CASE_INSENSITIVE
 };
 
+// Create a HashedString, adding the string to the backend map if it's new.
+// The map verifies the stored string on every hash match, if a different string already holds the hash
+// the string is re-hashed with the next seed until a free hash is found. Handles are therefore unique,
+// but a colliding string's handle depends on which of the two strings was created first.
+// Returns an invalid handle (see HashedString_IsValid) if inString is NULL or the string couldn't be stored,
+// e.g. the shared registry segment is full or the map is out of memory.
 HashedString_t HashedString_Create(const char* inString);
+// False for handles created from NULL or that failed to store their string. Invalid handles never compare equal
+bool HashedString_IsValid(const HashedString_t* inHashedString);
 const char* HashedString_GetString(const HashedString_t* inHashedString);
+// How many distinct strings collided with an existing one and were stored under a re-hashed handle
+uint32_t HashedString_GetNumCollisions(void);
 
 // Compare, case-sensitive
 bool HashedString_Compare(const HashedString_t* lhs, const HashedString_t* rhs);
 // Compare given sensitivity
 bool HashedString_Compare_WithSensitivity(const HashedString_t* lhs, const HashedString_t* rhs, const HashedStringCaseSensitivity sensitivity);
 
+// Lexical compare, case-sensitive. Returns <0, 0 or >0 like strcmp
+int HashedString_CompareLexical(const HashedString_t* lhs, const HashedString_t* rhs);
+// Lexical compare given sensitivity. Returns <0, 0 or >0 like strcmp
+int HashedString_CompareLexical_WithSensitivity(const HashedString_t* lhs, const HashedString_t* rhs, const HashedStringCaseSensitivity sensitivity);
 
 #endif // HASHEDSTRING_H
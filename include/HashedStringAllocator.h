@@ -0,0 +1,85 @@
+#ifndef HASHEDSTRINGALLOCATOR_H
+#define HASHEDSTRINGALLOCATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+// Allocation callbacks used for every allocation the library makes
+typedef struct HashedStringAllocator HashedStringAllocator_t;
+struct HashedStringAllocator
+{
+  // Allocate size bytes, suitably aligned for any type. Return NULL on failure
+  void* (*Alloc)(size_t size, void* userData);
+  // Free a previous allocation, size is the size that was originally requested
+  void (*Free)(void* ptr, size_t size, void* userData);
+  // Passed through to Alloc and Free
+  void* UserData;
+};
+
+// Allocator used by maps created without an explicit allocator, including the HashedString backend map.
+// Must be set before the first HashedString is created for it to apply to the backend map.
+// Passing NULL restores the malloc/free allocator
+void HashedStringAllocator_SetDefault(const HashedStringAllocator_t* allocator);
+const HashedStringAllocator_t* HashedStringAllocator_GetDefault(void);
+
+// Allocator used for short-lived temporaries (lower-casing long strings, sorting), defaults to the default allocator.
+// Passing NULL restores that behaviour
+void HashedStringAllocator_SetScratch(const HashedStringAllocator_t* allocator);
+const HashedStringAllocator_t* HashedStringAllocator_GetScratch(void);
+
+static inline void* HashedStringAllocator_Alloc(const HashedStringAllocator_t* allocator, size_t size)
+{
+  return allocator->Alloc(size, allocator->UserData);
+}
+
+static inline void HashedStringAllocator_Free(const HashedStringAllocator_t* allocator, void* ptr, size_t size)
+{
+  if (ptr)
+  {
+    allocator->Free(ptr, size, allocator->UserData);
+  }
+}
+
+// Round size up so whatever follows it keeps max_align_t alignment, same guarantee as malloc
+static inline size_t HashedStringAllocator_AlignSize(size_t size)
+{
+  const size_t alignment = alignof(max_align_t);
+  return (size + (alignment - 1)) & ~(alignment - 1);
+}
+
+// strdup equivalent, free with HashedStringAllocator_Free(allocator, str, strlen(str)+1)
+char* HashedStringAllocator_StrDup(const HashedStringAllocator_t* allocator, const char* inString);
+
+// Linear (arena/frame) allocator over a caller-provided buffer.
+// Frees are ignored unless they're the most recent allocation, Reset releases everything at once
+typedef struct HashedStringLinearAllocator HashedStringLinearAllocator_t;
+struct HashedStringLinearAllocator
+{
+  uint8_t* Buffer;
+  size_t Capacity;
+  size_t Offset;
+  // Highest Offset reached since Init
+  size_t PeakOffset;
+};
+
+void HashedStringLinearAllocator_Init(HashedStringLinearAllocator_t* linearAllocator, void* buffer, size_t capacity);
+void HashedStringLinearAllocator_Reset(HashedStringLinearAllocator_t* linearAllocator);
+HashedStringAllocator_t HashedStringLinearAllocator_GetAllocator(HashedStringLinearAllocator_t* linearAllocator);
+
+// Forwards to a backing allocator, counting bytes and allocations as it goes.
+// NOTE: Counters aren't atomic, same as HashedStringMap don't share one between threads
+typedef struct HashedStringTrackingAllocator HashedStringTrackingAllocator_t;
+struct HashedStringTrackingAllocator
+{
+  HashedStringAllocator_t Backing;
+  size_t BytesAllocated;
+  size_t PeakBytesAllocated;
+  uint32_t NumAllocations;
+};
+
+// backingAllocator may be NULL, in which case the current default allocator is used
+void HashedStringTrackingAllocator_Init(HashedStringTrackingAllocator_t* trackingAllocator, const HashedStringAllocator_t* backingAllocator);
+HashedStringAllocator_t HashedStringTrackingAllocator_GetAllocator(HashedStringTrackingAllocator_t* trackingAllocator);
+
+#endif // HASHEDSTRINGALLOCATOR_H
@@ -0,0 +1,69 @@
+#ifndef HASHEDSTRINGHASH_H
+#define HASHEDSTRINGHASH_H
+
+#include "HashedString.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Hash algorithms, values are persisted so never renumber them
+typedef enum HashedStringHashAlgorithm HashedStringHashAlgorithm;
+enum HashedStringHashAlgorithm
+{
+  HSHA_Unknown = 0,
+  // XXH3_64bits, or XXH3_128bits with HASHEDSTRING_USE_128BIT
+  HSHA_XXH3 = 1,
+  // XXH32, used with HASHEDSTRING_USE_32BIT
+  HSHA_XXH32 = 2,
+  // CityHash64, or CityHash32 with HASHEDSTRING_USE_32BIT
+  HSHA_CityHash = 3
+};
+
+typedef hsHash_t (*HashedStringHashFunc)(const void* data, size_t length, uint64_t seed);
+
+// One implementation (kernel) of a hash algorithm. Kernels of the same algorithm always produce identical hashes,
+// they only differ in which instruction set they use, so only the algorithm needs persisting
+typedef struct HashedStringHashBackend HashedStringHashBackend_t;
+struct HashedStringHashBackend
+{
+  HashedStringHashAlgorithm Algorithm;
+  // e.g. "xxh3-avx2"
+  const char* Name;
+  HashedStringHashFunc Hash;
+};
+
+// Everything needed to reproduce the hash of a string at a given re-hash attempt, check it on load before trusting persisted hashes.
+// NOTE: Not enough on its own to reproduce handles. A string that collided is stored under a later attempt, and which string
+// collides depends on which was interned first. Persist the interned strings in insertion order alongside this (as the
+// shared registry segment does) and re-intern them in that order on load
+typedef struct HashedStringHashInfo HashedStringHashInfo_t;
+struct HashedStringHashInfo
+{
+  uint32_t Algorithm;
+  // sizeof(hsHash_t)
+  uint32_t HashSize;
+  uint64_t Seed;
+};
+
+// Fastest kernel the running CPU supports, detected once on first use
+const HashedStringHashBackend_t* HashedStringHash_GetBestBackend(void);
+// Fastest supported kernel for the given algorithm, NULL if this build can't produce that algorithm
+const HashedStringHashBackend_t* HashedStringHash_FindBackend(HashedStringHashAlgorithm algorithm);
+// Every kernel in this build the running CPU supports, slowest first
+const HashedStringHashBackend_t* HashedStringHash_GetBackends(uint32_t* outNumBackends);
+
+static inline hsHash_t HashedStringHash_Hash(const HashedStringHashBackend_t* backend, const void* data, size_t length, uint64_t seed)
+{
+  return backend->Hash(data, length, seed);
+}
+
+// True if hashes made under lhs can be compared with hashes made under rhs
+bool HashedStringHashInfo_IsCompatible(const HashedStringHashInfo_t* lhs, const HashedStringHashInfo_t* rhs);
+
+// Choose the backend and seed used for every HashedString, defaults to the best backend for this CPU with seed 0.
+// Must be called before the first HashedString is created, returns false otherwise
+bool HashedString_SetHashing(const HashedStringHashBackend_t* backend, uint64_t seed);
+// Record this alongside any persisted HashedStrings, along with the interned strings in insertion order (see HashedStringHashInfo_t)
+HashedStringHashInfo_t HashedString_GetHashInfo(void);
+
+#endif // HASHEDSTRINGHASH_H
@@ -1,7 +1,9 @@
 #ifndef HASHEDSTRINGMAP_H
-#define HASHEDSTRINGMAP_h
+#define HASHEDSTRINGMAP_H
 
 #include "HashedString.h"
+#include "HashedStringAllocator.h"
+#include "HashedStringHash.h"
 #include <stdbool.h>
 
 // Default Map Growth Ratio
@@ -13,10 +15,15 @@ struct HashedStringEntry
 {
   // Corresponding Hash
   hsHash_t Key;
-  // Corresponding String
+  // Corresponding String, stored null-terminated in the same allocation directly after the entry
   char* String;
   uint32_t StringLength;
 
+  // First 8 bytes of String packed big-endian, lets most lexical comparisons resolve with one integer compare
+  uint64_t SortPrefix;
+  // Position of String in the map's lexical ordering, 0 if not yet ranked
+  uint32_t SortRank;
+
   // Pointer to next HashedString in this bucket
   struct HashedStringEntry* Next;
 };
@@ -30,21 +37,49 @@ struct HashedStringMap
   uint32_t NumElements;
   // When NumElements equals this value we grow the number of buckets, reallocate, and redistribute the map's contents
   uint32_t GrowthTrigger;
+  // How many elements have a valid SortRank, ranks are rebuilt lazily once enough unranked elements accumulate
+  uint32_t NumRankedElements;
+  // How many strings were added under a re-hashed hash, i.e. distinct strings whose first hash collided
+  uint32_t NumCollisions;
 
   struct HashedStringEntry** Buckets;
+
+  // Used for the buckets array, entries, and the map itself if made with HashedStringMap_Create
+  HashedStringAllocator_t Allocator;
+
+  // Used by HashedStringMap_HashString, defaults to the best backend for this CPU with seed 0
+  const HashedStringHashBackend_t* HashBackend;
+  uint64_t HashSeed;
 };
 
+// Create/Init using the default allocator
 HashedStringMap_t* HashedStringMap_Create(uint32_t initialSize);
 void HashedStringMap_Init(HashedStringMap_t* inMap, uint32_t initialSize);
+// Create/Init with the given allocator, NULL uses the default allocator
+HashedStringMap_t* HashedStringMap_CreateWithAllocator(uint32_t initialSize, const HashedStringAllocator_t* allocator);
+void HashedStringMap_InitWithAllocator(HashedStringMap_t* inMap, uint32_t initialSize, const HashedStringAllocator_t* allocator);
+// Free every entry and the buckets, the map itself is left for the caller (use with Init/InitWithAllocator)
 void HashedStringMap_Cleanup(HashedStringMap_t* inMap);
-HashedStringEntry_t* HashedStringMap_FindOrAdd(
+// Cleanup and free the map, only for maps made by Create/CreateWithAllocator
+void HashedStringMap_Destroy(HashedStringMap_t* inMap);
+// Change the hash backend and seed, a random seed makes it impractical for untrusted input (e.g. strings from network clients)
+// to be crafted to collide. Only possible while the map is empty, returns false otherwise
+bool HashedStringMap_SetHashing(HashedStringMap_t* inMap, const HashedStringHashBackend_t* backend, uint64_t seed);
+// Hash a string using this map's backend and seed. attempt is added to the seed, incremented when re-hashing after a collision
+hsHash_t HashedStringMap_HashString(const HashedStringMap_t* inMap, const char* inString, size_t length, uint32_t attempt);
+// Record this alongside any persisted hashes from this map, along with its strings in insertion order (see HashedStringHashInfo_t)
+HashedStringHashInfo_t HashedStringMap_GetHashInfo(const HashedStringMap_t* inMap);
+// Find the entry for inString under the given hash, adding it if the hash is unused.
+// attempt is the re-hash attempt the hash was made with (see HashedStringMap_HashString), adding under attempt > 0 counts a collision.
+// inString needn't be null-terminated, stringLength characters are compared and stored. NULL inString is rejected (returns NULL).
+// If the hash is already held by a different string nothing is added, NULL is returned and outCollision is set
+HashedStringEntry_t* HashedStringMap_FindOrAddVerified(
   HashedStringMap_t* inMap,
-  HashedString_t* hashedString,
-  const char* inString, 
-#ifdef HASHEDSTRING_ALLOW_CASE_INSENSITIVE
-  const char* inLCaseString, 
-  HashedStringEntry_t** outLCaseEntry
-#endif // HASHEDSTRING_ALLOW_CASE_INSENSITIVE 
+  const hsHash_t hash,
+  const uint32_t attempt,
+  const char* inString,
+  const uint32_t stringLength,
+  bool* outCollision
 );
 HashedStringEntry_t* HashedStringMap_Find(
   HashedStringMap_t* inMap,
@@ -54,5 +89,9 @@ HashedStringEntry_t* HashedStringMap_Find(
 #endif // HASHEDSTRING_ALLOW_CASE_INSENSITIVE
 );
 const char* HashedStringMap_GetString(HashedStringMap_t* inMap, const HashedString_t* hashedString);
+// Lexically compare the strings of two entries in this map, returns <0, 0 or >0 like strcmp
+int HashedStringMap_CompareEntriesLexical(HashedStringMap_t* inMap, const HashedStringEntry_t* lhs, const HashedStringEntry_t* rhs);
+// Sort every entry in the map and assign it a SortRank
+void HashedStringMap_RebuildSortRanks(HashedStringMap_t* inMap);
 
 #endif // HASHEDSTRINGMAP_H
@@ -0,0 +1,61 @@
+#ifndef HASHEDSTRINGSHAREDREGISTRY_H
+#define HASHEDSTRINGSHAREDREGISTRY_H
+
+#include "HashedString.h"
+#include "HashedStringHash.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+// Shared-memory registry, lets several processes (e.g. a pool of forked workers) share one copy of every string
+// and see identical handles. Backed by a POSIX shared-memory segment, so only available on POSIX platforms.
+#if !defined(HASHEDSTRING_HAS_SHARED_REGISTRY) && (defined(__unix__) || defined(__APPLE__))
+#define HASHEDSTRING_HAS_SHARED_REGISTRY 1
+#endif
+
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+
+// Process-local handle to a mapped registry segment
+typedef struct HashedStringSharedRegistry HashedStringSharedRegistry_t;
+
+// Create a new named segment of segmentSize bytes with a fixed number of buckets, fails if it already exists.
+// hashInfo is recorded in the segment and adopted by every process using it, NULL records HashedString_GetHashInfo().
+// The segment never grows, inserts fail once it's full. Children forked after this can use the returned handle directly
+HashedStringSharedRegistry_t* HashedStringSharedRegistry_Create(const char* name, size_t segmentSize, uint32_t numBuckets, const HashedStringHashInfo_t* hashInfo);
+// Map an existing segment made by HashedStringSharedRegistry_Create, fails if it doesn't exist, isn't fully created yet,
+// or was made with a different hash size
+HashedStringSharedRegistry_t* HashedStringSharedRegistry_Open(const char* name);
+// Unmap the segment and free the handle, the segment itself lives on until unlinked
+void HashedStringSharedRegistry_Close(HashedStringSharedRegistry_t* registry);
+// Remove the named segment, mappings already open remain valid
+bool HashedStringSharedRegistry_Unlink(const char* name);
+
+// Find the string stored under hash, adding it if the hash is unused. Inserts are serialised by a cross-process lock,
+// look-ups are lock-free. NULL inString is rejected. If the hash is already held by a different string NULL is returned and outCollision is set.
+// attempt is the re-hash attempt the hash was made with, adding under attempt > 0 counts a collision
+const char* HashedStringSharedRegistry_FindOrAddVerified(
+  HashedStringSharedRegistry_t* registry,
+  const hsHash_t hash,
+  const uint32_t attempt,
+  const char* inString,
+  const uint32_t stringLength,
+  bool* outCollision
+);
+// Lock-free look-up, NULL if nothing is stored under hash
+const char* HashedStringSharedRegistry_FindString(HashedStringSharedRegistry_t* registry, const hsHash_t hash);
+// Lexically compare the strings stored under two hashes, returns <0, 0 or >0 like strcmp. Unknown hashes sort first
+int HashedStringSharedRegistry_CompareLexical(HashedStringSharedRegistry_t* registry, const hsHash_t lhs, const hsHash_t rhs);
+
+uint32_t HashedStringSharedRegistry_GetNumElements(const HashedStringSharedRegistry_t* registry);
+uint32_t HashedStringSharedRegistry_GetNumCollisions(const HashedStringSharedRegistry_t* registry);
+// Bytes of the segment in use, including the header and buckets
+size_t HashedStringSharedRegistry_GetUsedBytes(const HashedStringSharedRegistry_t* registry);
+// Hashing every hash in the registry was made with
+HashedStringHashInfo_t HashedStringSharedRegistry_GetHashInfo(const HashedStringSharedRegistry_t* registry);
+
+// Back HashedStrings with this registry instead of the process-local map, adopting the registry's hash algorithm and seed.
+// Must be called before the first HashedString is created, returns false otherwise or if this build can't produce the registry's hashes
+bool HashedString_SetSharedRegistry(HashedStringSharedRegistry_t* registry);
+
+#endif // HASHEDSTRING_HAS_SHARED_REGISTRY
+
+#endif // HASHEDSTRINGSHAREDREGISTRY_H
@@ -1 +1,42 @@
 #pragma once
+#ifndef HIERARCHICALTAG_H
+#define HIERARCHICALTAG_H
+
+#include "HashedString.h"
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef HIERARCHICALTAG_SEPARATOR
+#define HIERARCHICALTAG_SEPARATOR '.'
+#endif
+
+typedef struct HierarchicalTag HierarchicalTag_t;
+
+#ifndef HASHEDSTRING_NO_SHORTTYPEDEFS
+typedef HierarchicalTag_t HTag;
+#endif
+
+// A tag of the form A.B.C, where A and A.B are its parents
+struct HierarchicalTag
+{
+  HashedString_t Tag;
+};
+
+HierarchicalTag_t HierarchicalTag_Create(const char* inString);
+const char* HierarchicalTag_GetString(const HierarchicalTag_t* inTag);
+
+// Exact compare, case-sensitive
+bool HierarchicalTag_Compare(const HierarchicalTag_t* lhs, const HierarchicalTag_t* rhs);
+// True if tag is a (possibly indirect) child of parent, e.g. A.B.C is a child of A.B and A, but not of A.B.C or A.Bee
+bool HierarchicalTag_IsChildOf(const HierarchicalTag_t* tag, const HierarchicalTag_t* parent);
+// True if tag is other or a child of other
+bool HierarchicalTag_Matches(const HierarchicalTag_t* tag, const HierarchicalTag_t* other);
+
+// HierarchicalTag_IsChildOf on already looked-up strings, for callers matching many tags against the same parent.
+// Parent must be a prefix ending exactly on a separator, so A.Bee isn't a child of A.B
+static inline bool HierarchicalTag_IsChildOfString(const char* tagString, const char* parentString, size_t parentLength)
+{
+  return strncmp(tagString, parentString, parentLength) == 0 && tagString[parentLength] == HIERARCHICALTAG_SEPARATOR;
+}
+
+#endif // HIERARCHICALTAG_H
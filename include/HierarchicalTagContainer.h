@@ -0,0 +1,109 @@
+#ifndef HIERARCHICALTAGCONTAINER_H
+#define HIERARCHICALTAGCONTAINER_H
+
+#include "HierachicalTag.h"
+#include "HashedStringAllocator.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// Growable array of tags, owned by whatever holds it
+typedef struct HierarchicalTagArray HierarchicalTagArray_t;
+struct HierarchicalTagArray
+{
+  HierarchicalTag_t* Tags;
+  uint32_t NumTags;
+  uint32_t Capacity;
+};
+
+// Holds a set of tags and tracks how it has changed since changes were last cleared,
+// so systems can react to what changed rather than rescanning every container
+typedef struct HierarchicalTagContainer HierarchicalTagContainer_t;
+struct HierarchicalTagContainer
+{
+  HierarchicalTagArray_t Tags;
+
+  // Incremented on every successful add or remove, compare against a previously seen value to detect changes
+  uint32_t Version;
+  // Net changes since the last clear. Adding then removing the same tag (or vice-versa) cancels out
+  HierarchicalTagArray_t AddedTags;
+  HierarchicalTagArray_t RemovedTags;
+
+  HashedStringAllocator_t Allocator;
+};
+
+// NULL allocator uses the default allocator
+void HierarchicalTagContainer_Init(HierarchicalTagContainer_t* container, const HashedStringAllocator_t* allocator);
+void HierarchicalTagContainer_Cleanup(HierarchicalTagContainer_t* container);
+
+// Returns false if the tag was already present, is invalid, or the change couldn't be recorded
+bool HierarchicalTagContainer_AddTag(HierarchicalTagContainer_t* container, const HierarchicalTag_t* tag);
+// Returns false if the tag wasn't present or the change couldn't be recorded
+bool HierarchicalTagContainer_RemoveTag(HierarchicalTagContainer_t* container, const HierarchicalTag_t* tag);
+// Exact match
+bool HierarchicalTagContainer_HasTag(const HierarchicalTagContainer_t* container, const HierarchicalTag_t* tag);
+// True if the container holds tag or any child of it
+bool HierarchicalTagContainer_HasTagMatching(const HierarchicalTagContainer_t* container, const HierarchicalTag_t* tag);
+
+// Any changes since the last clear?
+bool HierarchicalTagContainer_IsDirty(const HierarchicalTagContainer_t* container);
+void HierarchicalTagContainer_ClearChanges(HierarchicalTagContainer_t* container);
+
+// Called with every change matching the subscribed tag from one container at once.
+// Don't subscribe, unsubscribe, or change the container from inside the callback
+typedef void (*HierarchicalTagChangedCallback)(
+  void* userData,
+  const HierarchicalTagContainer_t* container,
+  const HierarchicalTag_t* addedTags, uint32_t numAdded,
+  const HierarchicalTag_t* removedTags, uint32_t numRemoved
+);
+
+typedef struct HierarchicalTagSubscription HierarchicalTagSubscription_t;
+struct HierarchicalTagSubscription
+{
+  HierarchicalTag_t Tag;
+  // Tag's string, looked up once on subscribe so matching children doesn't hit the map. NULL if Tag has no string
+  const char* TagString;
+  uint32_t TagLength;
+  // Also fire for changes to children of Tag, e.g. subscribing to Status fires for Status.Stunned
+  bool bIncludeChildren;
+  HierarchicalTagChangedCallback Callback;
+  void* UserData;
+  uint32_t Handle;
+};
+
+// Routes container changes to subscribers in batches
+typedef struct HierarchicalTagEventDispatcher HierarchicalTagEventDispatcher_t;
+struct HierarchicalTagEventDispatcher
+{
+  HierarchicalTagSubscription_t* Subscriptions;
+  uint32_t NumSubscriptions;
+  uint32_t SubscriptionCapacity;
+  uint32_t NextHandle;
+
+  // Reused between flushes to gather the changes for each subscription
+  HierarchicalTagArray_t BatchAdded;
+  HierarchicalTagArray_t BatchRemoved;
+  // Strings of the container's added then removed tags, looked up once per flush when a subscription includes children
+  const char** ChangeStrings;
+  uint32_t ChangeStringsCapacity;
+
+  HashedStringAllocator_t Allocator;
+};
+
+// NULL allocator uses the default allocator
+void HierarchicalTagEventDispatcher_Init(HierarchicalTagEventDispatcher_t* dispatcher, const HashedStringAllocator_t* allocator);
+void HierarchicalTagEventDispatcher_Cleanup(HierarchicalTagEventDispatcher_t* dispatcher);
+// Returns a handle for Unsubscribe, 0 on failure
+uint32_t HierarchicalTagEventDispatcher_Subscribe(
+  HierarchicalTagEventDispatcher_t* dispatcher,
+  const HierarchicalTag_t* tag,
+  bool bIncludeChildren,
+  HierarchicalTagChangedCallback callback,
+  void* userData
+);
+void HierarchicalTagEventDispatcher_Unsubscribe(HierarchicalTagEventDispatcher_t* dispatcher, uint32_t handle);
+// Fire each subscription at most once with the container's matching changes, then clear the container's changes.
+// Does nothing for containers that aren't dirty. Returns false without firing anything or clearing the changes if an allocation failed
+bool HierarchicalTagEventDispatcher_Flush(HierarchicalTagEventDispatcher_t* dispatcher, HierarchicalTagContainer_t* container);
+
+#endif // HIERARCHICALTAGCONTAINER_H
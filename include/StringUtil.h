@@ -4,26 +4,32 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdbool.h>
 #include <assert.h>
 
-#ifdef _MSC_VER
-// strsep shim, courtesy of https://stackoverflow.com/questions/9210528/split-string-with-delimiters-in-c
-static inline char* strsep(char** inString, const char* sep) 
+#include "HashedStringAllocator.h"
+
+// strsep alternative that splits on the whole seperator rather than any of its characters, so it agrees with CountSubStr.
+// strsep itself isn't standard C and isn't declared under -std=c17
+static inline char* StringUtil_StrSep(char** inString, const char* seperator)
 {
   if (*inString)
   {
     char* tokenStart = *inString;
-    *inString = strpbrk(tokenStart, sep);
-    if (*inString) 
+    char* seperatorStart = strstr(tokenStart, seperator);
+    if (seperatorStart)
+    {
+      *seperatorStart = '\0';
+      *inString = seperatorStart + strlen(seperator);
+    }
+    else
     {
-      **inString = '\0';
-      (*inString)++;
+      *inString = NULL;
     }
     return tokenStart;
   }
   return NULL;
 }
-#endif
 
 // MSVC apparently has strdup already, perhaps look into a reliable way of detecting if a shim is needed?
 #if defined(_MSC_VER) && __STDC_VERSION__ <= 201710L
@@ -68,48 +74,135 @@ static inline int32_t CountSubStr(const char* inString, const char* subStr)
         count++;
         place += subStrLen;
       }
+      return count;
     }
   }
   return 0;
 }
 
-static inline int32_t ExplodeString(const char* inString, const char* seperator, char** outStrings)
+// Pack the first 8 characters of a string into an integer such that comparing two prefixes orders them like strcmp
+static inline uint64_t StringSortPrefix(const char* inString)
+{
+  uint64_t prefix = 0;
+  if (inString)
+  {
+    for (int i = 0; i < 8; ++i)
+    {
+      const uint8_t c = (uint8_t)inString[i];
+      prefix |= (uint64_t)c << (56 - (i * 8));
+      if (c == '\0')
+      {
+        break;
+      }
+    }
+  }
+  return prefix;
+}
+
+// Lexically compare two strings given their StringSortPrefix, only touching the strings themselves if the prefixes match.
+// Returns <0, 0 or >0 like strcmp
+static inline int StringComparePrefixed(uint64_t lhsPrefix, const char* lhsString, uint32_t lhsLength, uint64_t rhsPrefix, const char* rhsString, uint32_t rhsLength)
+{
+  if (lhsPrefix != rhsPrefix)
+  {
+    return lhsPrefix < rhsPrefix ? -1 : 1;
+  }
+
+  // Prefixes match, if either string ends inside the prefix then both do and they're equal
+  if (lhsLength < 8 || rhsLength < 8)
+  {
+    return 0;
+  }
+  return strcmp(lhsString + 8, rhsString + 8);
+}
+
+static inline void FreeExplodedStrings_WithAllocator(const HashedStringAllocator_t* allocator, char** strings, int32_t numStrings)
 {
+  assert(allocator);
+  if (strings)
+  {
+    for (int32_t i = 0; i < numStrings; ++i)
+    {
+      HashedStringAllocator_Free(allocator, strings[i], strings[i] ? strlen(strings[i]) + 1 : 0);
+    }
+    HashedStringAllocator_Free(allocator, strings, numStrings * sizeof(char*));
+  }
+}
+
+// Split inString on seperator into a newly allocated array of newly allocated strings, returns how many strings there are.
+// Free the result with FreeExplodedStrings_WithAllocator using the same allocator
+static inline int32_t ExplodeString_WithAllocator(const HashedStringAllocator_t* allocator, const char* inString, const char* seperator, char*** outStrings)
+{
+    assert(allocator);
+    assert(outStrings);
     if (inString)
     {
-      const int32_t numTokens = CountSubStr(inString, seperator);
-      if (numTokens > 0)
+      // N seperators gives N+1 tokens
+      const int32_t numTokens = CountSubStr(inString, seperator) + 1;
+
+      // Allocate array of pointers for substrings
+      char** strings = (char**)HashedStringAllocator_Alloc(allocator, numTokens * sizeof(char*));
+      if (!strings)
       {
-        // Allocate array of pointers for substrings
-        outStrings = (char**)malloc(numTokens * sizeof(char*));
-        assert(outStrings);
+        *outStrings = NULL;
+        return 0;
+      }
+      // NULL until copied, so a partial result can be freed
+      memset(strings, 0, numTokens * sizeof(char*));
 
-        char* token = NULL;
-        char* dupStr = strdup(inString);
+      bool bCopiedAll = true;
+      if (numTokens > 1)
+      {
+        // Temporary copy, goes to the scratch allocator
+        const HashedStringAllocator_t* scratchAllocator = HashedStringAllocator_GetScratch();
+        const size_t dupStrSize = strlen(inString) + 1;
+        char* dupStr = HashedStringAllocator_StrDup(scratchAllocator, inString);
         char* beginDupStr = dupStr; // Keep pointer to beginning of duped string so we can free it
+        bCopiedAll = dupStr != NULL;
 
         // Butcher dupStr into substrings, copy them to output array
-        while ((token = strsep(&dupStr, seperator)))
+        char* token = NULL;
+        int32_t tokenIndex = 0;
+        while (bCopiedAll && (token = StringUtil_StrSep(&dupStr, seperator)))
         {
           // Copy token into outStrings
-          *outStrings = strdup(token);
-          outStrings++;
+          strings[tokenIndex] = HashedStringAllocator_StrDup(allocator, token);
+          bCopiedAll = strings[tokenIndex] != NULL;
+          tokenIndex++;
         }
 
         // Clean-up
-        free(beginDupStr);
-        return numTokens;
+        HashedStringAllocator_Free(scratchAllocator, beginDupStr, dupStrSize);
       }
       else // Special case, no substrings, return inString via outStrings
       {
-        outStrings = (char**)malloc(sizeof(char*));
-        assert(outStrings);
-        *outStrings = strdup(inString);
+        strings[0] = HashedStringAllocator_StrDup(allocator, inString);
+        bCopiedAll = strings[0] != NULL;
+      }
 
-        return 1;
+      if (!bCopiedAll)
+      {
+        // Out of memory part way through, don't hand out a partial result
+        FreeExplodedStrings_WithAllocator(allocator, strings, numTokens);
+        *outStrings = NULL;
+        return 0;
       }
+      *outStrings = strings;
+      return numTokens;
     }
+    *outStrings = NULL;
     return 0;
 }
 
+// ExplodeString/FreeExplodedStrings using the default allocator
+static inline int32_t ExplodeString(const char* inString, const char* seperator, char*** outStrings)
+{
+  return ExplodeString_WithAllocator(HashedStringAllocator_GetDefault(), inString, seperator, outStrings);
+}
+
+static inline void FreeExplodedStrings(char** strings, int32_t numStrings)
+{
+  FreeExplodedStrings_WithAllocator(HashedStringAllocator_GetDefault(), strings, numStrings);
+}
+
 #endif // HASHEDSTRING_STRINGUTIL_H
@@ -47,3 +47,4 @@ workspace "hierarchical-tags"
 
 include "htags-lib.lua"
 include "htags-tests.lua"
+include "htags-bench.lua"
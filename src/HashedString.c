@@ -1,5 +1,7 @@
 #include "HashedString.h"
 #include "HashedStringMap.h"
+#include "HashedStringHash.h"
+#include "HashedStringSharedRegistry.h"
 
 #include <stdbool.h>
 #include <stdalign.h>
@@ -10,16 +12,28 @@
 #endif // HASHEDSTRING_ALLOW_CASE_INSENSITIVE
 #include <assert.h>
 
-#ifdef HASHEDSTRING_USE_CITYHASH
-#include "city.h"
-#else
-#include "xxhash.h"
-#endif // HASHEDSTRING_USE_CITYHASH
-
 #ifndef HASHEDSTRING_MAP_INITIALSIZE
 #define HASHEDSTRING_MAP_INITIALSIZE 16
 #endif
 
+#ifndef HASHEDSTRING_MAX_REHASH_ATTEMPTS
+#define HASHEDSTRING_MAX_REHASH_ATTEMPTS 16
+#endif
+
+// Hashing the map singleton gets created with (after that the map's own settings are used), or the shared
+// registry's hashing when one is set. See HashedString_SetHashing and HashedString_SetSharedRegistry
+static const HashedStringHashBackend_t* HashBackend = NULL;
+static uint64_t HashSeed = 0;
+
+static const HashedStringHashBackend_t* GetHashBackend()
+{
+  if (!HashBackend)
+  {
+    HashBackend = HashedStringHash_GetBestBackend();
+  }
+  return HashBackend;
+}
+
 static bool bCreatedHashedStringMapSingleton = false;
 alignas(HashedStringMap_t) static uint8_t HashedStringMapSingletonData[sizeof(HashedStringMap_t)];
 
@@ -34,34 +48,83 @@ static HashedStringMap_t* GetHashedStringMap()
   else
   {
     HashedStringMap_Init(hashedStringMapSingleton, HASHEDSTRING_MAP_INITIALSIZE);
+    HashedStringMap_SetHashing(hashedStringMapSingleton, GetHashBackend(), HashSeed);
     bCreatedHashedStringMapSingleton = true;
     return hashedStringMapSingleton;
   }
 }
 
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+// When set, used instead of the process-local map
+static HashedStringSharedRegistry_t* SharedRegistry = NULL;
+#endif
+
 static HashedStringMap_t* GetHashedStringMapUnchecked()
 {
   HashedStringMap_t* hashedStringMapSingleton = (HashedStringMap_t*)HashedStringMapSingletonData;
   return hashedStringMapSingleton;
 }
 
-static hsHash_t HashString(const char* inString, size_t strLength)
+// Find or add the string in whichever store backs HashedStrings
+static bool FindOrAddString(const hsHash_t hash, const uint32_t attempt, const char* inString, const uint32_t stringLength, bool* outCollision)
 {
-// NOTE: Some of these functions accept a seed param, should that be exposed/used to improve hashing?
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+  if (SharedRegistry)
+  {
+    if (HashedStringSharedRegistry_FindOrAddVerified(SharedRegistry, hash, attempt, inString, stringLength, outCollision))
+    {
+      return true;
+    }
+    assert((*outCollision || !"Shared registry segment is full, create it with a larger segmentSize"));
+    return false;
+  }
+#endif
+  if (HashedStringMap_FindOrAddVerified(GetHashedStringMap(), hash, attempt, inString, stringLength, outCollision))
+  {
+    return true;
+  }
+  assert((*outCollision || !"Failed to allocate a HashedString map entry"));
+  return false;
+}
 
-#ifdef HASHEDSTRING_USE_32BIT
-#if HASHEDSTRING_USE_CITYHASH
-  return CityHash32(inString, strLength);
-#else
-  return XXH32(inString, strLength, 0);
-#endif // HASHEDSTRING_USE_CITYHASH
-#else
-#if HASHEDSTRING_USE_CITYHASH
-  return CityHash64(inString, strLength);
-#else
-  return XXH3_64bits(inString, strLength);
-#endif // HASHEDSTRING_USE_CITYHASH
-#endif // HASHEDSTRING_USE_32BIT
+// Hash with whichever store backs HashedStrings, attempt is added to its seed
+static hsHash_t HashString(const char* inString, size_t strLength, uint32_t attempt)
+{
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+  if (SharedRegistry)
+  {
+    return HashedStringHash_Hash(GetHashBackend(), inString, strLength, HashSeed + attempt);
+  }
+#endif
+  return HashedStringMap_HashString(GetHashedStringMap(), inString, strLength, attempt);
+}
+
+// Find or add the string, returning the hash it's stored under or hsHash_Null() if it couldn't be stored.
+// The store's seed is tried first, each collision with a different string moves on to the next seed
+static hsHash_t InternString(const char* inString, size_t strLength)
+{
+  for (uint32_t attempt = 0; attempt < HASHEDSTRING_MAX_REHASH_ATTEMPTS; ++attempt)
+  {
+    const hsHash_t hash = HashString(inString, strLength, attempt);
+    // The null hash marks invalid handles, treat it like a collision
+    if (hsHash_Equal(hash, hsHash_Null()))
+    {
+      continue;
+    }
+    bool bCollision = false;
+    if (FindOrAddString(hash, attempt, inString, (uint32_t)(strLength - 1), &bCollision))
+    {
+      return hash;
+    }
+    if (!bCollision)
+    {
+      // Store is full, already asserted
+      return hsHash_Null();
+    }
+  }
+
+  assert(!"Every seed collided, something is very wrong with the hash function");
+  return hsHash_Null();
 }
 
 // Copy and convert at the same time
@@ -79,61 +142,73 @@ HashedString_t HashedString_Create(const char* inString)
 {
   HashedString_t hStr;
 
-  if (inString == NULL)
-  {
-    hStr.Hash = 0;
+  hStr.Hash = hsHash_Null();
 #if HASHEDSTRING_ALLOW_CASE_INSENSITIVE
-    hStr.CommonHash = 0;
+  hStr.CommonHash = hsHash_Null();
 #endif
+
+  if (inString == NULL)
+  {
     return hStr;
   }
 
   const size_t strLength = strlen(inString)+1;
-  hStr.Hash = HashString(inString, strLength);
+
+  // Add to map for later look-up
+  const hsHash_t hash = InternString(inString, strLength);
+  if (hsHash_Equal(hash, hsHash_Null()))
+  {
+    return hStr;
+  }
 
 #if HASHEDSTRING_ALLOW_CASE_INSENSITIVE
-  hsHash_t lCaseHash = 0;
+  hsHash_t lCaseHash = hsHash_Null();
   if (strLength < 256)
   {
     // Reasonable sized buffer
     char lCaseString[256];
     StringToLowerCase(inString, lCaseString, strLength);
-    lCaseHash = HashString(lCaseString, strLength);
-
-    // Add to map for later look-up
-    HashedStringMap_t* stringMap = GetHashedStringMap();
-    HashedStringMap_FindOrAdd(stringMap, &hStr, inString, lCaseString, NULL);
+    lCaseHash = InternString(lCaseString, strLength);
   }
   else
   {
-    // long string requires dynamic alloc
-    char* lCaseString = (char*)malloc(strLength);
+    // long string requires dynamic alloc, only needed until it's interned
+    const HashedStringAllocator_t* scratchAllocator = HashedStringAllocator_GetScratch();
+    char* lCaseString = (char*)HashedStringAllocator_Alloc(scratchAllocator, strLength);
     if (lCaseString != NULL)
     {
       StringToLowerCase(inString, lCaseString, strLength);
+      lCaseHash = InternString(lCaseString, strLength);
     }
-    lCaseHash = HashString(lCaseString, strLength);
-
-    // Add to map for later look-up
-    HashedStringMap_t* stringMap = GetHashedStringMap();
-    HashedStringMap_FindOrAdd(stringMap, &hStr, inString, lCaseString, NULL);
-
-    free(lCaseString);
+    HashedStringAllocator_Free(scratchAllocator, lCaseString, strLength);
+  }
+  // Half a handle would compare wrongly one way or the other
+  if (hsHash_Equal(lCaseHash, hsHash_Null()))
+  {
+    return hStr;
   }
   hStr.CommonHash = lCaseHash;
-#else
-  // Add to map for later look-up
-  HashedStringMap* stringMap = GetHashedStringMap();
-  HashedStringMap_FindOrAdd(stringMap, &hStr, inString);
 #endif
 
+  hStr.Hash = hash;
   return hStr;
 }
 
+bool HashedString_IsValid(const HashedString_t* inHashedString)
+{
+  return inHashedString && !hsHash_Equal(inHashedString->Hash, hsHash_Null());
+}
+
 const char* HashedString_GetString(const HashedString_t* inHashedString)
 {
   if (inHashedString)
   {
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+    if (SharedRegistry)
+    {
+      return HashedStringSharedRegistry_FindString(SharedRegistry, inHashedString->Hash);
+    }
+#endif
     HashedStringMap_t* stringMap = GetHashedStringMap();
     const char* str = HashedStringMap_GetString(stringMap, inHashedString);
     return str;
@@ -141,6 +216,77 @@ const char* HashedString_GetString(const HashedString_t* inHashedString)
   return NULL;
 }
 
+uint32_t HashedString_GetNumCollisions(void)
+{
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+  if (SharedRegistry)
+  {
+    return HashedStringSharedRegistry_GetNumCollisions(SharedRegistry);
+  }
+#endif
+  return GetHashedStringMap()->NumCollisions;
+}
+
+bool HashedString_SetHashing(const HashedStringHashBackend_t* backend, uint64_t seed)
+{
+  assert(backend);
+  // Existing HashedStrings were made with the old hashing
+  if (bCreatedHashedStringMapSingleton)
+  {
+    return false;
+  }
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+  // The registry decides
+  if (SharedRegistry)
+  {
+    return false;
+  }
+#endif
+  HashBackend = backend;
+  HashSeed = seed;
+  return true;
+}
+
+HashedStringHashInfo_t HashedString_GetHashInfo(void)
+{
+  // Once created the map is what actually hashes, don't create it just to ask
+  if (bCreatedHashedStringMapSingleton)
+  {
+    return HashedStringMap_GetHashInfo(GetHashedStringMap());
+  }
+  HashedStringHashInfo_t hashInfo;
+  hashInfo.Algorithm = (uint32_t)GetHashBackend()->Algorithm;
+  hashInfo.HashSize = (uint32_t)sizeof(hsHash_t);
+  hashInfo.Seed = HashSeed;
+  return hashInfo;
+}
+
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+bool HashedString_SetSharedRegistry(HashedStringSharedRegistry_t* registry)
+{
+  // Strings already in the local map would be invisible to the registry and vice-versa
+  if (bCreatedHashedStringMapSingleton)
+  {
+    return false;
+  }
+
+  if (registry)
+  {
+    // Adopt the registry's hashing so every process makes the same handles, using whichever kernel suits this CPU
+    const HashedStringHashInfo_t registryHashInfo = HashedStringSharedRegistry_GetHashInfo(registry);
+    const HashedStringHashBackend_t* backend = HashedStringHash_FindBackend((HashedStringHashAlgorithm)registryHashInfo.Algorithm);
+    if (!backend || registryHashInfo.HashSize != sizeof(hsHash_t))
+    {
+      return false;
+    }
+    HashBackend = backend;
+    HashSeed = registryHashInfo.Seed;
+  }
+  SharedRegistry = registry;
+  return true;
+}
+#endif // HASHEDSTRING_HAS_SHARED_REGISTRY
+
 bool HashedString_Compare(const HashedString_t* lhs, const HashedString_t* rhs)
 {
   return false;// HashedString_Compare_WithSensitivity(lhs, rhs, HSCS_Sensitive);
@@ -150,14 +296,19 @@ bool HashedString_Compare_WithSensitivity(const HashedString_t* lhs, const Hashe
 {
   assert(lhs);
   assert(rhs);
+  // Invalid handles all share the null hash, don't let that make them equal
+  if (!HashedString_IsValid(lhs) || !HashedString_IsValid(rhs))
+  {
+    return false;
+  }
   if (sensitivity == HSCS_Sensitive)
   {
-    return lhs->Hash == rhs->Hash;
+    return hsHash_Equal(lhs->Hash, rhs->Hash);
   }
 #ifdef HASHEDSTRING_ALLOW_CASE_INSENSITIVE
   else if (sensitivity == HSCS_Insensitive)
   {
-    return lhs->CommonHash == rhs->CommonHash;
+    return hsHash_Equal(lhs->CommonHash, rhs->CommonHash);
   }
 #endif
   else
@@ -167,3 +318,52 @@ bool HashedString_Compare_WithSensitivity(const HashedString_t* lhs, const Hashe
     return false;
   }
 }
+
+int HashedString_CompareLexical(const HashedString_t* lhs, const HashedString_t* rhs)
+{
+  return HashedString_CompareLexical_WithSensitivity(lhs, rhs, HSCS_Sensitive);
+}
+
+int HashedString_CompareLexical_WithSensitivity(const HashedString_t* lhs, const HashedString_t* rhs, const HashedStringCaseSensitivity sensitivity)
+{
+  assert(lhs);
+  assert(rhs);
+
+  // Matching hashes means matching strings, no need to look anything up
+  if (HashedString_Compare_WithSensitivity(lhs, rhs, sensitivity))
+  {
+    return 0;
+  }
+
+  // Case-insensitive comparisons use the lower-cased entries, which order the same as a case-insensitive strcmp
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+  if (SharedRegistry)
+  {
+#ifdef HASHEDSTRING_ALLOW_CASE_INSENSITIVE
+    if (sensitivity == HSCS_Insensitive)
+    {
+      return HashedStringSharedRegistry_CompareLexical(SharedRegistry, lhs->CommonHash, rhs->CommonHash);
+    }
+#endif
+    return HashedStringSharedRegistry_CompareLexical(SharedRegistry, lhs->Hash, rhs->Hash);
+  }
+#endif
+  HashedStringMap_t* stringMap = GetHashedStringMap();
+  const HashedStringEntry_t* lhsEntry = HashedStringMap_Find(stringMap, lhs
+#ifdef HASHEDSTRING_ALLOW_CASE_INSENSITIVE
+    , sensitivity
+#endif
+  );
+  const HashedStringEntry_t* rhsEntry = HashedStringMap_Find(stringMap, rhs
+#ifdef HASHEDSTRING_ALLOW_CASE_INSENSITIVE
+    , sensitivity
+#endif
+  );
+
+  // Strings we know nothing about (e.g. created from NULL) sort first
+  if (!lhsEntry || !rhsEntry)
+  {
+    return (lhsEntry ? 1 : 0) - (rhsEntry ? 1 : 0);
+  }
+  return HashedStringMap_CompareEntriesLexical(stringMap, lhsEntry, rhsEntry);
+}
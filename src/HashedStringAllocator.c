@@ -0,0 +1,187 @@
+#include "HashedStringAllocator.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static void* MallocAllocator_Alloc(size_t size, void* userData)
+{
+  (void)userData;
+  return malloc(size);
+}
+
+static void MallocAllocator_Free(void* ptr, size_t size, void* userData)
+{
+  (void)size;
+  (void)userData;
+  free(ptr);
+}
+
+static const HashedStringAllocator_t MallocAllocator = { MallocAllocator_Alloc, MallocAllocator_Free, NULL };
+
+static HashedStringAllocator_t DefaultAllocator = { MallocAllocator_Alloc, MallocAllocator_Free, NULL };
+static HashedStringAllocator_t ScratchAllocator = { NULL, NULL, NULL };
+static bool bHasScratchAllocator = false;
+
+void HashedStringAllocator_SetDefault(const HashedStringAllocator_t* allocator)
+{
+  if (allocator)
+  {
+    assert(allocator->Alloc);
+    assert(allocator->Free);
+    DefaultAllocator = *allocator;
+  }
+  else
+  {
+    DefaultAllocator = MallocAllocator;
+  }
+}
+
+const HashedStringAllocator_t* HashedStringAllocator_GetDefault(void)
+{
+  return &DefaultAllocator;
+}
+
+void HashedStringAllocator_SetScratch(const HashedStringAllocator_t* allocator)
+{
+  if (allocator)
+  {
+    assert(allocator->Alloc);
+    assert(allocator->Free);
+    ScratchAllocator = *allocator;
+    bHasScratchAllocator = true;
+  }
+  else
+  {
+    bHasScratchAllocator = false;
+  }
+}
+
+const HashedStringAllocator_t* HashedStringAllocator_GetScratch(void)
+{
+  return bHasScratchAllocator ? &ScratchAllocator : &DefaultAllocator;
+}
+
+char* HashedStringAllocator_StrDup(const HashedStringAllocator_t* allocator, const char* inString)
+{
+  assert(allocator);
+  if (inString)
+  {
+    const size_t allocSize = strlen(inString) + 1;
+    char* dupedString = (char*)HashedStringAllocator_Alloc(allocator, allocSize);
+    if (dupedString)
+    {
+      memcpy(dupedString, inString, allocSize);
+    }
+    return dupedString;
+  }
+  return NULL;
+}
+
+static void* LinearAllocator_Alloc(size_t size, void* userData)
+{
+  HashedStringLinearAllocator_t* linearAllocator = (HashedStringLinearAllocator_t*)userData;
+  assert(linearAllocator);
+
+  const size_t alignedSize = HashedStringAllocator_AlignSize(size);
+  if (alignedSize > linearAllocator->Capacity - linearAllocator->Offset)
+  {
+    // Out of space
+    return NULL;
+  }
+
+  void* ptr = linearAllocator->Buffer + linearAllocator->Offset;
+  linearAllocator->Offset += alignedSize;
+  if (linearAllocator->Offset > linearAllocator->PeakOffset)
+  {
+    linearAllocator->PeakOffset = linearAllocator->Offset;
+  }
+  return ptr;
+}
+
+static void LinearAllocator_Free(void* ptr, size_t size, void* userData)
+{
+  HashedStringLinearAllocator_t* linearAllocator = (HashedStringLinearAllocator_t*)userData;
+  assert(linearAllocator);
+
+  // Only the most recent allocation can actually be given back
+  const size_t alignedSize = HashedStringAllocator_AlignSize(size);
+  if ((uint8_t*)ptr + alignedSize == linearAllocator->Buffer + linearAllocator->Offset)
+  {
+    linearAllocator->Offset -= alignedSize;
+  }
+}
+
+void HashedStringLinearAllocator_Init(HashedStringLinearAllocator_t* linearAllocator, void* buffer, size_t capacity)
+{
+  assert(linearAllocator);
+  assert(buffer || capacity == 0);
+
+  // Align the start of the buffer, shrinking capacity to match
+  const uintptr_t bufferStart = (uintptr_t)buffer;
+  const uintptr_t alignedStart = (uintptr_t)HashedStringAllocator_AlignSize((size_t)bufferStart);
+  const size_t padding = (size_t)(alignedStart - bufferStart);
+
+  linearAllocator->Buffer = (uint8_t*)alignedStart;
+  linearAllocator->Capacity = capacity > padding ? capacity - padding : 0;
+  linearAllocator->Offset = 0;
+  linearAllocator->PeakOffset = 0;
+}
+
+void HashedStringLinearAllocator_Reset(HashedStringLinearAllocator_t* linearAllocator)
+{
+  assert(linearAllocator);
+  linearAllocator->Offset = 0;
+}
+
+HashedStringAllocator_t HashedStringLinearAllocator_GetAllocator(HashedStringLinearAllocator_t* linearAllocator)
+{
+  HashedStringAllocator_t allocator = { LinearAllocator_Alloc, LinearAllocator_Free, linearAllocator };
+  return allocator;
+}
+
+static void* TrackingAllocator_Alloc(size_t size, void* userData)
+{
+  HashedStringTrackingAllocator_t* trackingAllocator = (HashedStringTrackingAllocator_t*)userData;
+  assert(trackingAllocator);
+
+  void* ptr = HashedStringAllocator_Alloc(&trackingAllocator->Backing, size);
+  if (ptr)
+  {
+    trackingAllocator->BytesAllocated += size;
+    trackingAllocator->NumAllocations++;
+    if (trackingAllocator->BytesAllocated > trackingAllocator->PeakBytesAllocated)
+    {
+      trackingAllocator->PeakBytesAllocated = trackingAllocator->BytesAllocated;
+    }
+  }
+  return ptr;
+}
+
+static void TrackingAllocator_Free(void* ptr, size_t size, void* userData)
+{
+  HashedStringTrackingAllocator_t* trackingAllocator = (HashedStringTrackingAllocator_t*)userData;
+  assert(trackingAllocator);
+  assert(trackingAllocator->BytesAllocated >= size);
+  assert(trackingAllocator->NumAllocations > 0);
+
+  HashedStringAllocator_Free(&trackingAllocator->Backing, ptr, size);
+  trackingAllocator->BytesAllocated -= size;
+  trackingAllocator->NumAllocations--;
+}
+
+void HashedStringTrackingAllocator_Init(HashedStringTrackingAllocator_t* trackingAllocator, const HashedStringAllocator_t* backingAllocator)
+{
+  assert(trackingAllocator);
+  trackingAllocator->Backing = backingAllocator ? *backingAllocator : *HashedStringAllocator_GetDefault();
+  trackingAllocator->BytesAllocated = 0;
+  trackingAllocator->PeakBytesAllocated = 0;
+  trackingAllocator->NumAllocations = 0;
+}
+
+HashedStringAllocator_t HashedStringTrackingAllocator_GetAllocator(HashedStringTrackingAllocator_t* trackingAllocator)
+{
+  HashedStringAllocator_t allocator = { TrackingAllocator_Alloc, TrackingAllocator_Free, trackingAllocator };
+  return allocator;
+}
@@ -0,0 +1,190 @@
+#include "HashedStringHash.h"
+#include "HashedStringHashKernels.h"
+
+#include <stdbool.h>
+#include <assert.h>
+
+#ifdef HASHEDSTRING_USE_CITYHASH
+#include "city.h"
+#else
+#include "xxhash.h"
+#endif // HASHEDSTRING_USE_CITYHASH
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#if !HASHEDSTRING_HAS_X86_KERNELS
+// Whatever the compiler settings for the library pick, via the linked hash library
+static hsHash_t HashedStringHash_Default(const void* data, size_t length, uint64_t seed)
+{
+#if defined(HASHEDSTRING_USE_128BIT)
+  const XXH128_hash_t hash128 = XXH3_128bits_withSeed(data, length, seed);
+  hsHash_t hash;
+  hash.Low64 = hash128.low64;
+  hash.High64 = hash128.high64;
+  return hash;
+#elif defined(HASHEDSTRING_USE_32BIT)
+#if HASHEDSTRING_USE_CITYHASH
+  // CityHash32 has no seeded variant, fall back to truncating the 64bit one when seeded
+  return seed == 0 ? CityHash32((const char*)data, length) : (hsHash_t)CityHash64WithSeed((const char*)data, length, seed);
+#else
+  return XXH32(data, length, (uint32_t)seed);
+#endif // HASHEDSTRING_USE_CITYHASH
+#else
+#if HASHEDSTRING_USE_CITYHASH
+  return seed == 0 ? CityHash64((const char*)data, length) : CityHash64WithSeed((const char*)data, length, seed);
+#else
+  return XXH3_64bits_withSeed(data, length, seed);
+#endif // HASHEDSTRING_USE_CITYHASH
+#endif // HASHEDSTRING_USE_128BIT
+}
+#endif // !HASHEDSTRING_HAS_X86_KERNELS
+
+#if defined(HASHEDSTRING_USE_CITYHASH)
+#define HASHEDSTRING_DEFAULT_ALGORITHM HSHA_CityHash
+#define HASHEDSTRING_DEFAULT_NAME "cityhash"
+#elif defined(HASHEDSTRING_USE_32BIT)
+#define HASHEDSTRING_DEFAULT_ALGORITHM HSHA_XXH32
+#define HASHEDSTRING_DEFAULT_NAME "xxh32"
+#else
+#define HASHEDSTRING_DEFAULT_ALGORITHM HSHA_XXH3
+#define HASHEDSTRING_DEFAULT_NAME "xxh3-default"
+#endif
+
+#if HASHEDSTRING_HAS_X86_KERNELS
+typedef struct HashedStringCpuFeatures HashedStringCpuFeatures_t;
+struct HashedStringCpuFeatures
+{
+  bool bSSE2;
+  bool bAVX2;
+  bool bAVX512;
+};
+
+// Checks both the CPU and that the OS saves the wider registers
+static HashedStringCpuFeatures_t HashedStringHash_DetectCpuFeatures(void)
+{
+  HashedStringCpuFeatures_t features = { false, false, false };
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int cpuInfo[4];
+  __cpuid(cpuInfo, 0);
+  const int maxLeaf = cpuInfo[0];
+
+  __cpuid(cpuInfo, 1);
+  features.bSSE2 = (cpuInfo[3] & (1 << 26)) != 0;
+  const bool bOSXSave = (cpuInfo[2] & (1 << 27)) != 0;
+  const bool bAVX = (cpuInfo[2] & (1 << 28)) != 0;
+
+  bool bYMMSaved = false;
+  bool bZMMSaved = false;
+  if (bOSXSave && bAVX)
+  {
+    const unsigned long long xcr0 = _xgetbv(0);
+    bYMMSaved = (xcr0 & 0x6) == 0x6;
+    bZMMSaved = (xcr0 & 0xE6) == 0xE6;
+  }
+
+  if (maxLeaf >= 7)
+  {
+    __cpuidex(cpuInfo, 7, 0);
+    features.bAVX2 = bYMMSaved && (cpuInfo[1] & (1 << 5)) != 0;
+    features.bAVX512 = bZMMSaved && (cpuInfo[1] & (1 << 16)) != 0;
+  }
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  // These account for OS support too
+  __builtin_cpu_init();
+  features.bSSE2 = __builtin_cpu_supports("sse2");
+  features.bAVX2 = __builtin_cpu_supports("avx2");
+  features.bAVX512 = __builtin_cpu_supports("avx512f");
+#endif
+  return features;
+}
+#endif // HASHEDSTRING_HAS_X86_KERNELS
+
+#define HASHEDSTRING_MAX_BACKENDS 5
+
+static HashedStringHashBackend_t Backends[HASHEDSTRING_MAX_BACKENDS];
+static uint32_t NumBackends = 0;
+static bool bDetectedBackends = false;
+
+static void HashedStringHash_AddBackend(HashedStringHashAlgorithm algorithm, const char* name, HashedStringHashFunc hash)
+{
+  assert(NumBackends < HASHEDSTRING_MAX_BACKENDS);
+  HashedStringHashBackend_t* backend = &Backends[NumBackends++];
+  backend->Algorithm = algorithm;
+  backend->Name = name;
+  backend->Hash = hash;
+}
+
+// Fill in Backends, slowest first.
+// NOTE: Not thread-safe, same as the rest of the library. Call HashedStringHash_GetBestBackend up front if that matters
+static void HashedStringHash_DetectBackends(void)
+{
+  if (bDetectedBackends)
+  {
+    return;
+  }
+
+#if HASHEDSTRING_HAS_XXH3_KERNELS
+  HashedStringHash_AddBackend(HSHA_XXH3, "xxh3-scalar", HashedStringHash_XXH3_Scalar);
+#endif
+
+#if HASHEDSTRING_HAS_X86_KERNELS
+  // The default kernel isn't added here, on x86 it's the same as one of these
+  const HashedStringCpuFeatures_t features = HashedStringHash_DetectCpuFeatures();
+  if (features.bSSE2)
+  {
+    HashedStringHash_AddBackend(HSHA_XXH3, "xxh3-sse2", HashedStringHash_XXH3_SSE2);
+  }
+  if (features.bAVX2)
+  {
+    HashedStringHash_AddBackend(HSHA_XXH3, "xxh3-avx2", HashedStringHash_XXH3_AVX2);
+  }
+  if (features.bAVX512)
+  {
+    HashedStringHash_AddBackend(HSHA_XXH3, "xxh3-avx512", HashedStringHash_XXH3_AVX512);
+  }
+#else
+  HashedStringHash_AddBackend(HASHEDSTRING_DEFAULT_ALGORITHM, HASHEDSTRING_DEFAULT_NAME, HashedStringHash_Default);
+#endif
+
+  bDetectedBackends = true;
+}
+
+const HashedStringHashBackend_t* HashedStringHash_GetBestBackend(void)
+{
+  HashedStringHash_DetectBackends();
+  assert(NumBackends > 0);
+  return &Backends[NumBackends - 1];
+}
+
+const HashedStringHashBackend_t* HashedStringHash_FindBackend(HashedStringHashAlgorithm algorithm)
+{
+  HashedStringHash_DetectBackends();
+  for (uint32_t i = NumBackends; i > 0; --i)
+  {
+    if (Backends[i - 1].Algorithm == algorithm)
+    {
+      return &Backends[i - 1];
+    }
+  }
+  return NULL;
+}
+
+const HashedStringHashBackend_t* HashedStringHash_GetBackends(uint32_t* outNumBackends)
+{
+  HashedStringHash_DetectBackends();
+  if (outNumBackends)
+  {
+    *outNumBackends = NumBackends;
+  }
+  return Backends;
+}
+
+bool HashedStringHashInfo_IsCompatible(const HashedStringHashInfo_t* lhs, const HashedStringHashInfo_t* rhs)
+{
+  assert(lhs);
+  assert(rhs);
+  return lhs->Algorithm == rhs->Algorithm && lhs->HashSize == rhs->HashSize && lhs->Seed == rhs->Seed;
+}
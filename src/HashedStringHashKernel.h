@@ -0,0 +1,20 @@
+// Shared body for the XXH3 kernels. Each kernel source defines XXH_VECTOR and HASHEDSTRING_XXH3_KERNEL_NAME,
+// includes xxhash.h with XXH_INLINE_ALL so the whole of XXH3 is compiled for that instruction set, then includes this.
+// Deliberately no include guard
+#ifndef HASHEDSTRING_XXH3_KERNEL_NAME
+#error "Define HASHEDSTRING_XXH3_KERNEL_NAME before including HashedStringHashKernel.h"
+#endif
+
+hsHash_t HASHEDSTRING_XXH3_KERNEL_NAME(const void* data, size_t length, uint64_t seed);
+hsHash_t HASHEDSTRING_XXH3_KERNEL_NAME(const void* data, size_t length, uint64_t seed)
+{
+#if defined(HASHEDSTRING_USE_128BIT)
+  const XXH128_hash_t hash128 = XXH3_128bits_withSeed(data, length, seed);
+  hsHash_t hash;
+  hash.Low64 = hash128.low64;
+  hash.High64 = hash128.high64;
+  return hash;
+#else
+  return XXH3_64bits_withSeed(data, length, seed);
+#endif
+}
@@ -0,0 +1,25 @@
+#pragma once
+#ifndef HASHEDSTRINGHASHKERNELS_H
+#define HASHEDSTRINGHASHKERNELS_H
+
+#include "HashedString.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-instruction-set XXH3 kernels only make sense when XXH3 is the hash in use
+#if !defined(HASHEDSTRING_USE_32BIT) && !defined(HASHEDSTRING_USE_CITYHASH)
+#define HASHEDSTRING_HAS_XXH3_KERNELS 1
+
+hsHash_t HashedStringHash_XXH3_Scalar(const void* data, size_t length, uint64_t seed);
+
+#if !defined(HASHEDSTRING_NO_X86_KERNELS) && (defined(__x86_64__) || defined(_M_X64))
+#define HASHEDSTRING_HAS_X86_KERNELS 1
+// Each of these lives in its own source file built for that instruction set, only call them once the CPU is known to support it
+hsHash_t HashedStringHash_XXH3_SSE2(const void* data, size_t length, uint64_t seed);
+hsHash_t HashedStringHash_XXH3_AVX2(const void* data, size_t length, uint64_t seed);
+hsHash_t HashedStringHash_XXH3_AVX512(const void* data, size_t length, uint64_t seed);
+#endif
+
+#endif
+
+#endif // HASHEDSTRINGHASHKERNELS_H
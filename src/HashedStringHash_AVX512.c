@@ -0,0 +1,13 @@
+// XXH3 kernel using AVX512, must be built with AVX512 enabled (see htags-lib.lua)
+#include "HashedStringHashKernels.h"
+
+#if HASHEDSTRING_HAS_X86_KERNELS
+
+#define XXH_INLINE_ALL
+#define XXH_VECTOR XXH_AVX512
+#include "xxhash.h"
+
+#define HASHEDSTRING_XXH3_KERNEL_NAME HashedStringHash_XXH3_AVX512
+#include "HashedStringHashKernel.h"
+
+#endif // HASHEDSTRING_HAS_X86_KERNELS
@@ -0,0 +1,13 @@
+// XXH3 kernel using SSE2, must be built with SSE2 enabled (see htags-lib.lua)
+#include "HashedStringHashKernels.h"
+
+#if HASHEDSTRING_HAS_X86_KERNELS
+
+#define XXH_INLINE_ALL
+#define XXH_VECTOR XXH_SSE2
+#include "xxhash.h"
+
+#define HASHEDSTRING_XXH3_KERNEL_NAME HashedStringHash_XXH3_SSE2
+#include "HashedStringHashKernel.h"
+
+#endif // HASHEDSTRING_HAS_X86_KERNELS
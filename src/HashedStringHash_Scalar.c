@@ -0,0 +1,13 @@
+// XXH3 kernel using portable scalar code, the fallback when no vector kernel is usable
+#include "HashedStringHashKernels.h"
+
+#if HASHEDSTRING_HAS_XXH3_KERNELS
+
+#define XXH_INLINE_ALL
+#define XXH_VECTOR XXH_SCALAR
+#include "xxhash.h"
+
+#define HASHEDSTRING_XXH3_KERNEL_NAME HashedStringHash_XXH3_Scalar
+#include "HashedStringHashKernel.h"
+
+#endif // HASHEDSTRING_HAS_XXH3_KERNELS
@@ -5,24 +5,28 @@
 #include <assert.h>
 #include <math.h>
 
-// Create a new HashedStringEntry given a key (hash) and the corresponding string
-static HashedStringEntry_t* HashedStringEntry_Create(hsHash_t inKey, const char* inString)
+// Entries and their strings share a single allocation, string immediately follows the entry
+static size_t HashedStringEntry_GetAllocSize(const uint32_t stringLength)
 {
-  HashedStringEntry_t* newEntry = (HashedStringEntry_t*)malloc(sizeof(HashedStringEntry_t));
+  return sizeof(HashedStringEntry_t) + stringLength + 1;
+}
+
+// Create a new HashedStringEntry given a key (hash) and the corresponding string.
+// Copies exactly stringLength characters, inString doesn't need to be terminated
+static HashedStringEntry_t* HashedStringEntry_Create(const HashedStringAllocator_t* allocator, hsHash_t inKey, const char* inString, const uint32_t stringLength)
+{
+  assert(inString);
+  HashedStringEntry_t* newEntry = (HashedStringEntry_t*)HashedStringAllocator_Alloc(allocator, HashedStringEntry_GetAllocSize(stringLength));
   if (newEntry)
   {
     newEntry->Key = inKey;
-    const size_t stringLength = inString ? strlen(inString)+1 : 0;
-    if (stringLength > 0)
-    {
-      // Copy string
-      newEntry->String = strdup(inString);
-      assert(newEntry->String);
-    }
-    else
-    {
-      newEntry->String = NULL;
-    }
+    // Copy string
+    newEntry->String = (char*)(newEntry + 1);
+    memcpy(newEntry->String, inString, stringLength);
+    newEntry->String[stringLength] = '\0';
+    newEntry->StringLength = stringLength;
+    newEntry->SortPrefix = StringSortPrefix(newEntry->String);
+    newEntry->SortRank = 0;
     newEntry->Next = NULL;
 
     return newEntry;
@@ -37,9 +41,9 @@ static HashedStringEntry_t* HashedStringEntry_GetEnd(HashedStringEntry_t* headOf
   if (headOfList)
   {
     HashedStringEntry_t* endPtr = headOfList;
-    while (headOfList->Next)
+    while (endPtr->Next)
     {
-      endPtr = headOfList->Next;
+      endPtr = endPtr->Next;
     }
     assert(endPtr->Next == NULL);
     return endPtr;
@@ -81,16 +85,15 @@ static void HashedStringEntry_AppendEnd(HashedStringEntry_t* entry, HashedString
 }
 
 // free a chain of entries
-static void HashedStringEntry_Cleanup(HashedStringEntry_t* entry)
+static void HashedStringEntry_Cleanup(const HashedStringAllocator_t* allocator, HashedStringEntry_t* entry)
 {
   if (entry)
   {
     HashedStringEntry_t* next = entry->Next;
-    free(entry->String);
-    free(entry);
+    HashedStringAllocator_Free(allocator, entry, HashedStringEntry_GetAllocSize(entry->StringLength));
     if (next)
     {
-      HashedStringEntry_Cleanup(next);
+      HashedStringEntry_Cleanup(allocator, next);
     }
   }
 }
@@ -98,7 +101,7 @@ static void HashedStringEntry_Cleanup(HashedStringEntry_t* entry)
 static uint32_t HashedStringMap_GetBucketIndex(HashedStringMap_t* inMap, const hsHash_t hash)
 {
   assert(inMap);
-  return hash % inMap->NumBuckets;
+  return (uint32_t)(hsHash_Fold(hash) % inMap->NumBuckets);
 }
 
 // Get head entry in bucket
@@ -124,33 +127,59 @@ static uint32_t HashedStringMap_GetGrowthTrigger(uint32_t size)
 }
 
 HashedStringMap_t* HashedStringMap_Create(uint32_t initialSize)
+{
+  return HashedStringMap_CreateWithAllocator(initialSize, NULL);
+}
+
+HashedStringMap_t* HashedStringMap_CreateWithAllocator(uint32_t initialSize, const HashedStringAllocator_t* allocator)
 {
   assert(initialSize > 0);
+  if (!allocator)
+  {
+    allocator = HashedStringAllocator_GetDefault();
+  }
 
-  HashedStringMap_t* newMap = (HashedStringMap_t*)malloc(sizeof(HashedStringMap_t));
+  HashedStringMap_t* newMap = (HashedStringMap_t*)HashedStringAllocator_Alloc(allocator, sizeof(HashedStringMap_t));
   if (newMap)
   {
-    HashedStringMap_Init(newMap, initialSize);
+    HashedStringMap_InitWithAllocator(newMap, initialSize, allocator);
   }
   return newMap;
 }
 
 void HashedStringMap_Init(HashedStringMap_t* inMap, uint32_t initialSize)
+{
+  HashedStringMap_InitWithAllocator(inMap, initialSize, NULL);
+}
+
+void HashedStringMap_InitWithAllocator(HashedStringMap_t* inMap, uint32_t initialSize, const HashedStringAllocator_t* allocator)
 {
   assert(inMap);
   assert(initialSize > 0);
 
+  // Keep our own copy, the default may change after we're created
+  inMap->Allocator = allocator ? *allocator : *HashedStringAllocator_GetDefault();
+
   inMap->NumBuckets = initialSize;
   inMap->NumElements = 0;
   inMap->GrowthTrigger = HashedStringMap_GetGrowthTrigger(initialSize);
+  inMap->NumRankedElements = 0;
+  inMap->NumCollisions = 0;
+  inMap->HashBackend = HashedStringHash_GetBestBackend();
+  inMap->HashSeed = 0;
 
   // Allocate array of empty (NULL) buckets
   const size_t allocSize = initialSize * sizeof(HashedStringEntry_t*);
-  inMap->Buckets = (HashedStringEntry_t**)malloc(allocSize);
+  inMap->Buckets = (HashedStringEntry_t**)HashedStringAllocator_Alloc(&inMap->Allocator, allocSize);
   if (inMap->Buckets)
   {
     memset(inMap->Buckets, 0, allocSize);
   }
+  else
+  {
+    // Every add will fail, but look-ups still work
+    inMap->NumBuckets = 0;
+  }
 }
 
 void HashedStringMap_Cleanup(HashedStringMap_t* inMap)
@@ -162,14 +191,29 @@ void HashedStringMap_Cleanup(HashedStringMap_t* inMap)
       HashedStringEntry_t* bucket = inMap->Buckets[i];
       if (bucket)
       {
-        HashedStringEntry_Cleanup(bucket);
+        HashedStringEntry_Cleanup(&inMap->Allocator, bucket);
       }
     }
-    free(inMap->Buckets);
-    free(inMap);
+
+    HashedStringAllocator_Free(&inMap->Allocator, inMap->Buckets, inMap->NumBuckets * sizeof(HashedStringEntry_t*));
+    inMap->Buckets = NULL;
+    inMap->NumBuckets = 0;
+    inMap->NumElements = 0;
+    inMap->NumRankedElements = 0;
   }  
 }
 
+void HashedStringMap_Destroy(HashedStringMap_t* inMap)
+{
+  if (inMap)
+  {
+    // Copy the allocator out before freeing the map it lives in
+    const HashedStringAllocator_t allocator = inMap->Allocator;
+    HashedStringMap_Cleanup(inMap);
+    HashedStringAllocator_Free(&allocator, inMap, sizeof(HashedStringMap_t));
+  }
+}
+
 static void HashedStringMap_GrowAndRebuild(HashedStringMap_t* inMap)
 {
   assert(inMap);
@@ -178,8 +222,12 @@ static void HashedStringMap_GrowAndRebuild(HashedStringMap_t* inMap)
   assert(newNumBuckets > 0);
 
   // Allocate new buckets array, set all to NULL initially
-  HashedStringEntry_t** newBuckets = (HashedStringEntry_t**)malloc(newNumBuckets * sizeof(HashedStringEntry_t*));
-  assert(newBuckets);
+  HashedStringEntry_t** newBuckets = (HashedStringEntry_t**)HashedStringAllocator_Alloc(&inMap->Allocator, newNumBuckets * sizeof(HashedStringEntry_t*));
+  if (!newBuckets)
+  {
+    // Keep the old buckets, longer bucket lists are better than losing the map. We'll try again on the next add
+    return;
+  }
   for (uint32_t b = 0; b < newNumBuckets; ++b)
   {
     newBuckets[b] = NULL;
@@ -229,20 +277,28 @@ static void HashedStringMap_GrowAndRebuild(HashedStringMap_t* inMap)
   }
 
   // Free old buckets array
-  free(oldBuckets);
+  HashedStringAllocator_Free(&inMap->Allocator, oldBuckets, numBuckets * sizeof(HashedStringEntry_t*));
 }
 
 static HashedStringEntry_t* HashedStringMap_AddInternal(
   HashedStringMap_t* inMap,
   const hsHash_t hash,
-  const char* inString
+  const char* inString,
+  const uint32_t stringLength
 )
 {
   assert(inMap);
+  if (!inMap->Buckets)
+  {
+    return NULL;
+  }
 
   // Make new entry
-  HashedStringEntry_t* newEntry = HashedStringEntry_Create(hash, inString);
-  assert(newEntry);
+  HashedStringEntry_t* newEntry = HashedStringEntry_Create(&inMap->Allocator, hash, inString, stringLength);
+  if (!newEntry)
+  {
+    return NULL;
+  }
 
   // Find bucket
   const uint32_t bucketIndex = HashedStringMap_GetBucketIndex(inMap, hash);
@@ -268,56 +324,104 @@ static HashedStringEntry_t* HashedStringMap_AddInternal(
   return newEntry;
 }
 
-HashedStringEntry_t* HashedStringMap_FindOrAdd(
+bool HashedStringMap_SetHashing(HashedStringMap_t* inMap, const HashedStringHashBackend_t* backend, uint64_t seed)
+{
+  assert(inMap);
+  assert(backend);
+  if (inMap->NumElements > 0)
+  {
+    // Existing keys were made with the old hashing
+    return false;
+  }
+  inMap->HashBackend = backend;
+  inMap->HashSeed = seed;
+  return true;
+}
+
+hsHash_t HashedStringMap_HashString(const HashedStringMap_t* inMap, const char* inString, size_t length, uint32_t attempt)
+{
+  assert(inMap);
+  return HashedStringHash_Hash(inMap->HashBackend, inString, length, inMap->HashSeed + attempt);
+}
+
+HashedStringHashInfo_t HashedStringMap_GetHashInfo(const HashedStringMap_t* inMap)
+{
+  assert(inMap);
+  HashedStringHashInfo_t hashInfo;
+  hashInfo.Algorithm = (uint32_t)inMap->HashBackend->Algorithm;
+  hashInfo.HashSize = (uint32_t)sizeof(hsHash_t);
+  hashInfo.Seed = inMap->HashSeed;
+  return hashInfo;
+}
+
+// Find the entry holding this exact key, if any
+static HashedStringEntry_t* HashedStringMap_FindKey(HashedStringMap_t* inMap, const hsHash_t hash)
+{
+  assert(inMap);
+  if (inMap->NumBuckets == 0)
+  {
+    return NULL;
+  }
+
+  // Get bucket index
+  const uint32_t bucketIndex = HashedStringMap_GetBucketIndex(inMap, hash);
+  HashedStringEntry_t* entry = HashedStringMap_GetBucket(inMap, bucketIndex);
+
+  // Traverse list until entry->Key == hash or we run out of entries
+  while (entry && !hsHash_Equal(entry->Key, hash))
+  {
+    entry = entry->Next;
+  }
+  return entry;
+}
+
+// Check the entry actually holds the given string, not just a string with the same hash
+static bool HashedStringEntry_Matches(const HashedStringEntry_t* entry, const char* inString, const uint32_t stringLength)
+{
+  return entry->StringLength == stringLength && memcmp(entry->String, inString, stringLength) == 0;
+}
+
+HashedStringEntry_t* HashedStringMap_FindOrAddVerified(
   HashedStringMap_t* inMap,
-  HashedString_t* hashedString,
+  const hsHash_t hash,
+  const uint32_t attempt,
   const char* inString,
-#ifdef HASHEDSTRING_ALLOW_CASE_INSENSITIVE
-  const char* inLCaseString,
-  HashedStringEntry_t** outLCaseEntry
-#endif // HASHEDSTRING_ALLOW_CASE_INSENSITIVE
+  const uint32_t stringLength,
+  bool* outCollision
 )
 {
-  if (inMap && hashedString)
+  if (outCollision)
   {
-    HashedStringEntry_t* outEntry;
+    *outCollision = false;
+  }
 
-    // Try find case-sensitive entry
-    HashedStringEntry_t* existingEntry = HashedStringMap_Find(inMap, hashedString
-#ifdef HASHEDSTRING_ALLOW_CASE_INSENSITIVE
-      , HSCS_Sensitive
-#endif
-    );
+  // Same as the shared registry, there's no string to store
+  if (inMap && inString)
+  {
+    HashedStringEntry_t* existingEntry = HashedStringMap_FindKey(inMap, hash);
 
     // If one doesn't exist, add it
     if (!existingEntry)
     {
-      const hsHash_t hash = hashedString->Hash;
-      outEntry = HashedStringMap_AddInternal(inMap, hash, inString);      
-    }
-    else
-    {
-      outEntry = existingEntry;
+      HashedStringEntry_t* newEntry = HashedStringMap_AddInternal(inMap, hash, inString, stringLength);
+      // Only count each colliding string once, when it finally lands under a later seed
+      if (newEntry && attempt > 0)
+      {
+        inMap->NumCollisions++;
+      }
+      return newEntry;
     }
 
-#ifdef HASHEDSTRING_ALLOW_CASE_INSENSITIVE
-    // Try find case-insensitive entry
-    HashedStringEntry_t* existingLCaseEntry = HashedStringMap_Find(inMap, hashedString, HSCS_Insensitive);
-    if (!existingLCaseEntry)
+    if (HashedStringEntry_Matches(existingEntry, inString, stringLength))
     {
-      const hsHash_t hash = hashedString->CommonHash;
-      HashedStringEntry_t* lCaseEntry = HashedStringMap_AddInternal(inMap, hash, inLCaseString);
-      if (outLCaseEntry)
-      {
-        *outLCaseEntry = lCaseEntry;
-      }
+      return existingEntry;
     }
-    else if (outLCaseEntry)
+
+    // Same hash, different string. Leave the existing entry alone, caller has to pick another hash
+    if (outCollision)
     {
-      *outLCaseEntry = existingLCaseEntry;
+      *outCollision = true;
     }
-#endif
-    return outEntry;
   }
   return NULL;
 }
@@ -338,16 +442,7 @@ HashedStringEntry_t* HashedStringMap_Find(
     const hsHash_t hash = hashedString->Hash;
 #endif
 
-    // Get bucket index
-    const uint32_t bucketIndex = HashedStringMap_GetBucketIndex(inMap, hash);
-    HashedStringEntry_t* entry = HashedStringMap_GetBucket(inMap, bucketIndex);
-    
-    // Traverse list until entry->Key == hash or we run out of entries
-    while (entry && entry->Key != hash)
-    {
-      entry = entry->Next;
-    }
-    return entry;
+    return HashedStringMap_FindKey(inMap, hash);
   }
   return NULL;
 }
@@ -368,3 +463,78 @@ const char* HashedStringMap_GetString(HashedStringMap_t* inMap, const HashedStri
   }
   return NULL;
 }
+
+// Compare using the cached prefix, only touching the strings themselves if the prefixes match
+static int HashedStringEntry_CompareLexical(const HashedStringEntry_t* lhs, const HashedStringEntry_t* rhs)
+{
+  return StringComparePrefixed(lhs->SortPrefix, lhs->String, lhs->StringLength, rhs->SortPrefix, rhs->String, rhs->StringLength);
+}
+
+static int HashedStringEntry_QSortCompare(const void* lhs, const void* rhs)
+{
+  return HashedStringEntry_CompareLexical(*(const HashedStringEntry_t* const*)lhs, *(const HashedStringEntry_t* const*)rhs);
+}
+
+void HashedStringMap_RebuildSortRanks(HashedStringMap_t* inMap)
+{
+  assert(inMap);
+  if (inMap->NumElements == 0)
+  {
+    return;
+  }
+
+  // Gather every entry into a flat array
+  const HashedStringAllocator_t* scratchAllocator = HashedStringAllocator_GetScratch();
+  const size_t sortedEntriesSize = inMap->NumElements * sizeof(HashedStringEntry_t*);
+  HashedStringEntry_t** sortedEntries = (HashedStringEntry_t**)HashedStringAllocator_Alloc(scratchAllocator, sortedEntriesSize);
+  if (!sortedEntries)
+  {
+    // Existing ranks stay valid, unranked entries keep falling back to prefix comparison
+    return;
+  }
+  uint32_t numEntries = 0;
+  for (uint32_t b = 0; b < inMap->NumBuckets; ++b)
+  {
+    for (HashedStringEntry_t* entry = inMap->Buckets[b]; entry; entry = entry->Next)
+    {
+      assert(numEntries < inMap->NumElements);
+      sortedEntries[numEntries++] = entry;
+    }
+  }
+
+  qsort(sortedEntries, numEntries, sizeof(HashedStringEntry_t*), HashedStringEntry_QSortCompare);
+
+  // Ranks start at 1, 0 is reserved for "unranked"
+  for (uint32_t i = 0; i < numEntries; ++i)
+  {
+    sortedEntries[i]->SortRank = i + 1;
+  }
+  inMap->NumRankedElements = numEntries;
+
+  HashedStringAllocator_Free(scratchAllocator, sortedEntries, sortedEntriesSize);
+}
+
+int HashedStringMap_CompareEntriesLexical(HashedStringMap_t* inMap, const HashedStringEntry_t* lhs, const HashedStringEntry_t* rhs)
+{
+  assert(inMap);
+  assert(lhs);
+  assert(rhs);
+  if (lhs == rhs)
+  {
+    return 0;
+  }
+
+  // Rebuild once unranked entries make up more than an eighth of the map, otherwise new entries fall back to prefix comparison.
+  // NOTE: Adding entries doesn't change the relative order of existing ranks, so they stay valid between rebuilds
+  const uint32_t numUnranked = inMap->NumElements - inMap->NumRankedElements;
+  if (numUnranked > inMap->NumRankedElements / 8)
+  {
+    HashedStringMap_RebuildSortRanks(inMap);
+  }
+
+  if (lhs->SortRank && rhs->SortRank)
+  {
+    return lhs->SortRank < rhs->SortRank ? -1 : 1;
+  }
+  return HashedStringEntry_CompareLexical(lhs, rhs);
+}
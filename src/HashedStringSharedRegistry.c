@@ -0,0 +1,431 @@
+#if !defined(_WIN32) && !defined(_XOPEN_SOURCE)
+// shm_open, robust mutexes etc.
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "HashedStringSharedRegistry.h"
+
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+
+#include "HashedStringAllocator.h"
+#include "StringUtil.h"
+
+#include <stdatomic.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 'HTRG'
+#define SHAREDREGISTRY_MAGIC 0x48545247u
+#define SHAREDREGISTRY_VERSION 2u
+
+// Everything in the segment refers to everything else by offset from the start of the segment, as each process
+// may map it at a different address. Offset 0 is the header, so doubles as "null"
+typedef uint64_t SharedRegistryOffset_t;
+
+typedef struct SharedRegistryHeader SharedRegistryHeader_t;
+struct SharedRegistryHeader
+{
+  // Written last on creation, Open refuses segments without it
+  _Atomic uint32_t Magic;
+  uint32_t Version;
+  // sizeof(hsHash_t), processes built with a different hash size can't share a registry
+  uint32_t HashSize;
+  // HashedStringHashAlgorithm and seed every hash in the registry was made with
+  uint32_t HashAlgorithm;
+  uint64_t HashSeed;
+  uint32_t NumBuckets;
+  uint64_t SegmentSize;
+  // Start of the bucket array, each bucket is the offset of the first entry in it
+  SharedRegistryOffset_t BucketsOffset;
+
+  // Bump-allocation point for new entries, only advanced while holding InsertLock
+  _Atomic uint64_t UsedBytes;
+  _Atomic uint32_t NumElements;
+  _Atomic uint32_t NumCollisions;
+
+  // Serialises inserts across processes, look-ups never take it
+  pthread_mutex_t InsertLock;
+};
+
+typedef struct SharedRegistryEntry SharedRegistryEntry_t;
+struct SharedRegistryEntry
+{
+  hsHash_t Key;
+  // Next entry in this bucket
+  _Atomic SharedRegistryOffset_t Next;
+  // See StringSortPrefix
+  uint64_t SortPrefix;
+  uint32_t StringLength;
+  // StringLength characters plus terminator
+  char String[];
+};
+
+struct HashedStringSharedRegistry
+{
+  SharedRegistryHeader_t* Header;
+  size_t SegmentSize;
+};
+
+static uint8_t* SharedRegistry_GetBase(const HashedStringSharedRegistry_t* registry)
+{
+  return (uint8_t*)registry->Header;
+}
+
+static _Atomic SharedRegistryOffset_t* SharedRegistry_GetBuckets(const HashedStringSharedRegistry_t* registry)
+{
+  return (_Atomic SharedRegistryOffset_t*)(SharedRegistry_GetBase(registry) + registry->Header->BucketsOffset);
+}
+
+static SharedRegistryEntry_t* SharedRegistry_GetEntry(const HashedStringSharedRegistry_t* registry, const SharedRegistryOffset_t offset)
+{
+  return offset ? (SharedRegistryEntry_t*)(SharedRegistry_GetBase(registry) + offset) : NULL;
+}
+
+static uint32_t SharedRegistry_GetBucketIndex(const HashedStringSharedRegistry_t* registry, const hsHash_t hash)
+{
+  return (uint32_t)(hsHash_Fold(hash) % registry->Header->NumBuckets);
+}
+
+static void SharedRegistry_Lock(SharedRegistryHeader_t* header)
+{
+  const int result = pthread_mutex_lock(&header->InsertLock);
+#if defined(__linux__)
+  if (result == EOWNERDEAD)
+  {
+    // A process died holding the lock. Entries are only published once fully written, so at worst it leaked some space
+    pthread_mutex_consistent(&header->InsertLock);
+    return;
+  }
+#endif
+  assert(result == 0);
+  (void)result;
+}
+
+static void SharedRegistry_Unlock(SharedRegistryHeader_t* header)
+{
+  pthread_mutex_unlock(&header->InsertLock);
+}
+
+// Lock-free, entries are published with release stores once complete
+static SharedRegistryEntry_t* SharedRegistry_FindEntry(const HashedStringSharedRegistry_t* registry, const hsHash_t hash)
+{
+  _Atomic SharedRegistryOffset_t* buckets = SharedRegistry_GetBuckets(registry);
+  const uint32_t bucketIndex = SharedRegistry_GetBucketIndex(registry, hash);
+
+  SharedRegistryOffset_t offset = atomic_load_explicit(&buckets[bucketIndex], memory_order_acquire);
+  while (offset)
+  {
+    SharedRegistryEntry_t* entry = SharedRegistry_GetEntry(registry, offset);
+    if (hsHash_Equal(entry->Key, hash))
+    {
+      return entry;
+    }
+    offset = atomic_load_explicit(&entry->Next, memory_order_acquire);
+  }
+  return NULL;
+}
+
+static bool SharedRegistryEntry_Matches(const SharedRegistryEntry_t* entry, const char* inString, const uint32_t stringLength)
+{
+  return entry->StringLength == stringLength && memcmp(entry->String, inString, stringLength) == 0;
+}
+
+// Resolve an existing entry against the string we wanted to add
+static const char* SharedRegistry_ResolveExisting(const SharedRegistryEntry_t* entry, const char* inString, const uint32_t stringLength, bool* outCollision)
+{
+  if (SharedRegistryEntry_Matches(entry, inString, stringLength))
+  {
+    return entry->String;
+  }
+
+  // Same hash, different string. Caller has to pick another hash
+  if (outCollision)
+  {
+    *outCollision = true;
+  }
+  return NULL;
+}
+
+static HashedStringSharedRegistry_t* SharedRegistry_CreateHandle(SharedRegistryHeader_t* header, size_t segmentSize)
+{
+  HashedStringSharedRegistry_t* registry = (HashedStringSharedRegistry_t*)HashedStringAllocator_Alloc(HashedStringAllocator_GetDefault(), sizeof(HashedStringSharedRegistry_t));
+  if (registry)
+  {
+    registry->Header = header;
+    registry->SegmentSize = segmentSize;
+  }
+  return registry;
+}
+
+HashedStringSharedRegistry_t* HashedStringSharedRegistry_Create(const char* name, size_t segmentSize, uint32_t numBuckets, const HashedStringHashInfo_t* hashInfo)
+{
+  assert(name);
+  assert(numBuckets > 0);
+
+  const HashedStringHashInfo_t currentHashInfo = HashedString_GetHashInfo();
+  if (!hashInfo)
+  {
+    hashInfo = &currentHashInfo;
+  }
+  if (hashInfo->HashSize != sizeof(hsHash_t))
+  {
+    return NULL;
+  }
+
+  const size_t bucketsOffset = HashedStringAllocator_AlignSize(sizeof(SharedRegistryHeader_t));
+  const size_t entriesOffset = HashedStringAllocator_AlignSize(bucketsOffset + numBuckets * sizeof(SharedRegistryOffset_t));
+  if (segmentSize <= entriesOffset)
+  {
+    // No room for any entries
+    return NULL;
+  }
+
+  const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+  {
+    return NULL;
+  }
+  if (ftruncate(fd, (off_t)segmentSize) != 0)
+  {
+    close(fd);
+    shm_unlink(name);
+    return NULL;
+  }
+
+  void* segment = mmap(NULL, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED)
+  {
+    shm_unlink(name);
+    return NULL;
+  }
+
+  // ftruncate zero-fills, so every bucket already starts empty
+  SharedRegistryHeader_t* header = (SharedRegistryHeader_t*)segment;
+  header->Version = SHAREDREGISTRY_VERSION;
+  header->HashSize = (uint32_t)sizeof(hsHash_t);
+  header->HashAlgorithm = hashInfo->Algorithm;
+  header->HashSeed = hashInfo->Seed;
+  header->NumBuckets = numBuckets;
+  header->SegmentSize = segmentSize;
+  header->BucketsOffset = bucketsOffset;
+  atomic_init(&header->UsedBytes, entriesOffset);
+  atomic_init(&header->NumElements, 0);
+  atomic_init(&header->NumCollisions, 0);
+
+  pthread_mutexattr_t lockAttributes;
+  pthread_mutexattr_init(&lockAttributes);
+  pthread_mutexattr_setpshared(&lockAttributes, PTHREAD_PROCESS_SHARED);
+#if defined(__linux__)
+  pthread_mutexattr_setrobust(&lockAttributes, PTHREAD_MUTEX_ROBUST);
+#endif
+  pthread_mutex_init(&header->InsertLock, &lockAttributes);
+  pthread_mutexattr_destroy(&lockAttributes);
+
+  // Publish
+  atomic_store_explicit(&header->Magic, SHAREDREGISTRY_MAGIC, memory_order_release);
+
+  HashedStringSharedRegistry_t* registry = SharedRegistry_CreateHandle(header, segmentSize);
+  if (!registry)
+  {
+    munmap(segment, segmentSize);
+    shm_unlink(name);
+  }
+  return registry;
+}
+
+HashedStringSharedRegistry_t* HashedStringSharedRegistry_Open(const char* name)
+{
+  assert(name);
+
+  const int fd = shm_open(name, O_RDWR, 0600);
+  if (fd < 0)
+  {
+    return NULL;
+  }
+
+  struct stat segmentStat;
+  if (fstat(fd, &segmentStat) != 0 || segmentStat.st_size < (off_t)sizeof(SharedRegistryHeader_t))
+  {
+    close(fd);
+    return NULL;
+  }
+  const size_t segmentSize = (size_t)segmentStat.st_size;
+
+  void* segment = mmap(NULL, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED)
+  {
+    return NULL;
+  }
+
+  SharedRegistryHeader_t* header = (SharedRegistryHeader_t*)segment;
+  if (atomic_load_explicit(&header->Magic, memory_order_acquire) != SHAREDREGISTRY_MAGIC
+    || header->Version != SHAREDREGISTRY_VERSION
+    || header->HashSize != sizeof(hsHash_t)
+    || header->SegmentSize != segmentSize)
+  {
+    munmap(segment, segmentSize);
+    return NULL;
+  }
+
+  HashedStringSharedRegistry_t* registry = SharedRegistry_CreateHandle(header, segmentSize);
+  if (!registry)
+  {
+    munmap(segment, segmentSize);
+  }
+  return registry;
+}
+
+void HashedStringSharedRegistry_Close(HashedStringSharedRegistry_t* registry)
+{
+  if (registry)
+  {
+    munmap(registry->Header, registry->SegmentSize);
+    HashedStringAllocator_Free(HashedStringAllocator_GetDefault(), registry, sizeof(HashedStringSharedRegistry_t));
+  }
+}
+
+bool HashedStringSharedRegistry_Unlink(const char* name)
+{
+  assert(name);
+  return shm_unlink(name) == 0;
+}
+
+const char* HashedStringSharedRegistry_FindOrAddVerified(
+  HashedStringSharedRegistry_t* registry,
+  const hsHash_t hash,
+  const uint32_t attempt,
+  const char* inString,
+  const uint32_t stringLength,
+  bool* outCollision
+)
+{
+  if (outCollision)
+  {
+    *outCollision = false;
+  }
+  if (!registry || !inString)
+  {
+    return NULL;
+  }
+
+  // Fast path, no lock needed if it's already there
+  const SharedRegistryEntry_t* existingEntry = SharedRegistry_FindEntry(registry, hash);
+  if (existingEntry)
+  {
+    return SharedRegistry_ResolveExisting(existingEntry, inString, stringLength, outCollision);
+  }
+
+  SharedRegistryHeader_t* header = registry->Header;
+  SharedRegistry_Lock(header);
+
+  // Someone may have added it while we waited
+  existingEntry = SharedRegistry_FindEntry(registry, hash);
+  if (existingEntry)
+  {
+    SharedRegistry_Unlock(header);
+    return SharedRegistry_ResolveExisting(existingEntry, inString, stringLength, outCollision);
+  }
+
+  // Bump-allocate the new entry
+  const uint64_t entryOffset = atomic_load_explicit(&header->UsedBytes, memory_order_relaxed);
+  const size_t entrySize = HashedStringAllocator_AlignSize(sizeof(SharedRegistryEntry_t) + stringLength + 1);
+  if (entrySize > header->SegmentSize - entryOffset)
+  {
+    // Segment is full
+    SharedRegistry_Unlock(header);
+    return NULL;
+  }
+  atomic_store_explicit(&header->UsedBytes, entryOffset + entrySize, memory_order_relaxed);
+
+  _Atomic SharedRegistryOffset_t* buckets = SharedRegistry_GetBuckets(registry);
+  const uint32_t bucketIndex = SharedRegistry_GetBucketIndex(registry, hash);
+
+  SharedRegistryEntry_t* newEntry = SharedRegistry_GetEntry(registry, entryOffset);
+  newEntry->Key = hash;
+  newEntry->SortPrefix = StringSortPrefix(inString);
+  newEntry->StringLength = stringLength;
+  memcpy(newEntry->String, inString, stringLength);
+  newEntry->String[stringLength] = '\0';
+
+  // Push onto the front of the bucket, readers see either the old or new head, never a partial entry
+  atomic_store_explicit(&newEntry->Next, atomic_load_explicit(&buckets[bucketIndex], memory_order_relaxed), memory_order_relaxed);
+  atomic_store_explicit(&buckets[bucketIndex], entryOffset, memory_order_release);
+  atomic_fetch_add_explicit(&header->NumElements, 1, memory_order_relaxed);
+  // Only count each colliding string once, when it finally lands under a later seed
+  if (attempt > 0)
+  {
+    atomic_fetch_add_explicit(&header->NumCollisions, 1, memory_order_relaxed);
+  }
+
+  SharedRegistry_Unlock(header);
+  return newEntry->String;
+}
+
+const char* HashedStringSharedRegistry_FindString(HashedStringSharedRegistry_t* registry, const hsHash_t hash)
+{
+  if (registry)
+  {
+    const SharedRegistryEntry_t* entry = SharedRegistry_FindEntry(registry, hash);
+    if (entry)
+    {
+      return entry->String;
+    }
+  }
+  return NULL;
+}
+
+int HashedStringSharedRegistry_CompareLexical(HashedStringSharedRegistry_t* registry, const hsHash_t lhs, const hsHash_t rhs)
+{
+  assert(registry);
+  const SharedRegistryEntry_t* lhsEntry = SharedRegistry_FindEntry(registry, lhs);
+  const SharedRegistryEntry_t* rhsEntry = SharedRegistry_FindEntry(registry, rhs);
+  if (!lhsEntry || !rhsEntry)
+  {
+    return (lhsEntry ? 1 : 0) - (rhsEntry ? 1 : 0);
+  }
+  if (lhsEntry == rhsEntry)
+  {
+    return 0;
+  }
+
+  // No shared sort ranks, entries are immutable once published so the cached prefix is as far as we go
+  return StringComparePrefixed(lhsEntry->SortPrefix, lhsEntry->String, lhsEntry->StringLength, rhsEntry->SortPrefix, rhsEntry->String, rhsEntry->StringLength);
+}
+
+uint32_t HashedStringSharedRegistry_GetNumElements(const HashedStringSharedRegistry_t* registry)
+{
+  assert(registry);
+  return atomic_load_explicit(&registry->Header->NumElements, memory_order_relaxed);
+}
+
+uint32_t HashedStringSharedRegistry_GetNumCollisions(const HashedStringSharedRegistry_t* registry)
+{
+  assert(registry);
+  return atomic_load_explicit(&registry->Header->NumCollisions, memory_order_relaxed);
+}
+
+size_t HashedStringSharedRegistry_GetUsedBytes(const HashedStringSharedRegistry_t* registry)
+{
+  assert(registry);
+  return (size_t)atomic_load_explicit(&registry->Header->UsedBytes, memory_order_relaxed);
+}
+
+HashedStringHashInfo_t HashedStringSharedRegistry_GetHashInfo(const HashedStringSharedRegistry_t* registry)
+{
+  assert(registry);
+  HashedStringHashInfo_t hashInfo;
+  hashInfo.Algorithm = registry->Header->HashAlgorithm;
+  hashInfo.HashSize = registry->Header->HashSize;
+  hashInfo.Seed = registry->Header->HashSeed;
+  return hashInfo;
+}
+
+#endif // HASHEDSTRING_HAS_SHARED_REGISTRY
@@ -0,0 +1,51 @@
+#include "HierachicalTag.h"
+
+#include <string.h>
+#include <assert.h>
+
+HierarchicalTag_t HierarchicalTag_Create(const char* inString)
+{
+  HierarchicalTag_t tag;
+  tag.Tag = HashedString_Create(inString);
+  return tag;
+}
+
+const char* HierarchicalTag_GetString(const HierarchicalTag_t* inTag)
+{
+  if (inTag)
+  {
+    return HashedString_GetString(&inTag->Tag);
+  }
+  return NULL;
+}
+
+bool HierarchicalTag_Compare(const HierarchicalTag_t* lhs, const HierarchicalTag_t* rhs)
+{
+  assert(lhs);
+  assert(rhs);
+  return HashedString_Compare_WithSensitivity(&lhs->Tag, &rhs->Tag, HSCS_Sensitive);
+}
+
+bool HierarchicalTag_IsChildOf(const HierarchicalTag_t* tag, const HierarchicalTag_t* parent)
+{
+  assert(tag);
+  assert(parent);
+  if (HierarchicalTag_Compare(tag, parent))
+  {
+    return false;
+  }
+
+  const char* tagString = HierarchicalTag_GetString(tag);
+  const char* parentString = HierarchicalTag_GetString(parent);
+  if (!tagString || !parentString)
+  {
+    return false;
+  }
+
+  return HierarchicalTag_IsChildOfString(tagString, parentString, strlen(parentString));
+}
+
+bool HierarchicalTag_Matches(const HierarchicalTag_t* tag, const HierarchicalTag_t* other)
+{
+  return HierarchicalTag_Compare(tag, other) || HierarchicalTag_IsChildOf(tag, other);
+}
@@ -0,0 +1,374 @@
+#include "HierarchicalTagContainer.h"
+
+#include <string.h>
+#include <assert.h>
+
+#ifndef HIERARCHICALTAG_ARRAY_INITIALSIZE
+#define HIERARCHICALTAG_ARRAY_INITIALSIZE 4
+#endif
+
+static void HierarchicalTagArray_Init(HierarchicalTagArray_t* array)
+{
+  array->Tags = NULL;
+  array->NumTags = 0;
+  array->Capacity = 0;
+}
+
+static void HierarchicalTagArray_Cleanup(HierarchicalTagArray_t* array, const HashedStringAllocator_t* allocator)
+{
+  HashedStringAllocator_Free(allocator, array->Tags, array->Capacity * sizeof(HierarchicalTag_t));
+  HierarchicalTagArray_Init(array);
+}
+
+static int32_t HierarchicalTagArray_Find(const HierarchicalTagArray_t* array, const HierarchicalTag_t* tag)
+{
+  for (uint32_t i = 0; i < array->NumTags; ++i)
+  {
+    if (HierarchicalTag_Compare(&array->Tags[i], tag))
+    {
+      return (int32_t)i;
+    }
+  }
+  return -1;
+}
+
+// Make sure the array can hold at least minCapacity tags without allocating
+static bool HierarchicalTagArray_Reserve(HierarchicalTagArray_t* array, const uint32_t minCapacity, const HashedStringAllocator_t* allocator)
+{
+  if (minCapacity <= array->Capacity)
+  {
+    return true;
+  }
+
+  // Double, same idea as the map growing early to avoid doing it often
+  uint32_t newCapacity = array->Capacity ? array->Capacity * 2 : HIERARCHICALTAG_ARRAY_INITIALSIZE;
+  while (newCapacity < minCapacity)
+  {
+    newCapacity *= 2;
+  }
+  HierarchicalTag_t* newTags = (HierarchicalTag_t*)HashedStringAllocator_Alloc(allocator, newCapacity * sizeof(HierarchicalTag_t));
+  if (!newTags)
+  {
+    return false;
+  }
+  if (array->NumTags > 0)
+  {
+    memcpy(newTags, array->Tags, array->NumTags * sizeof(HierarchicalTag_t));
+  }
+  HashedStringAllocator_Free(allocator, array->Tags, array->Capacity * sizeof(HierarchicalTag_t));
+  array->Tags = newTags;
+  array->Capacity = newCapacity;
+  return true;
+}
+
+static bool HierarchicalTagArray_Push(HierarchicalTagArray_t* array, const HierarchicalTag_t* tag, const HashedStringAllocator_t* allocator)
+{
+  if (!HierarchicalTagArray_Reserve(array, array->NumTags + 1, allocator))
+  {
+    return false;
+  }
+  array->Tags[array->NumTags++] = *tag;
+  return true;
+}
+
+// Order isn't preserved, last tag is moved into the gap
+static void HierarchicalTagArray_RemoveAtSwap(HierarchicalTagArray_t* array, const uint32_t index)
+{
+  assert(index < array->NumTags);
+  array->Tags[index] = array->Tags[--array->NumTags];
+}
+
+void HierarchicalTagContainer_Init(HierarchicalTagContainer_t* container, const HashedStringAllocator_t* allocator)
+{
+  assert(container);
+  HierarchicalTagArray_Init(&container->Tags);
+  HierarchicalTagArray_Init(&container->AddedTags);
+  HierarchicalTagArray_Init(&container->RemovedTags);
+  container->Version = 0;
+  container->Allocator = allocator ? *allocator : *HashedStringAllocator_GetDefault();
+}
+
+void HierarchicalTagContainer_Cleanup(HierarchicalTagContainer_t* container)
+{
+  if (container)
+  {
+    HierarchicalTagArray_Cleanup(&container->Tags, &container->Allocator);
+    HierarchicalTagArray_Cleanup(&container->AddedTags, &container->Allocator);
+    HierarchicalTagArray_Cleanup(&container->RemovedTags, &container->Allocator);
+  }
+}
+
+// Record a change, cancelling out the opposite change if one is pending.
+// Callers reserve room in changes first, so this can't fail
+static void HierarchicalTagContainer_RecordChange(HierarchicalTagContainer_t* container, const HierarchicalTag_t* tag, HierarchicalTagArray_t* changes, HierarchicalTagArray_t* oppositeChanges)
+{
+  const int32_t oppositeIndex = HierarchicalTagArray_Find(oppositeChanges, tag);
+  if (oppositeIndex >= 0)
+  {
+    HierarchicalTagArray_RemoveAtSwap(oppositeChanges, (uint32_t)oppositeIndex);
+  }
+  else
+  {
+    assert(changes->NumTags < changes->Capacity);
+    changes->Tags[changes->NumTags++] = *tag;
+  }
+  container->Version++;
+}
+
+bool HierarchicalTagContainer_AddTag(HierarchicalTagContainer_t* container, const HierarchicalTag_t* tag)
+{
+  assert(container);
+  assert(tag);
+  // Invalid tags never compare equal, so they'd pile up as duplicates
+  if (!HashedString_IsValid(&tag->Tag) || HierarchicalTagArray_Find(&container->Tags, tag) >= 0)
+  {
+    return false;
+  }
+  // Reserve first so a change is never made without being recorded
+  if (!HierarchicalTagArray_Reserve(&container->AddedTags, container->AddedTags.NumTags + 1, &container->Allocator)
+    || !HierarchicalTagArray_Push(&container->Tags, tag, &container->Allocator))
+  {
+    return false;
+  }
+  HierarchicalTagContainer_RecordChange(container, tag, &container->AddedTags, &container->RemovedTags);
+  return true;
+}
+
+bool HierarchicalTagContainer_RemoveTag(HierarchicalTagContainer_t* container, const HierarchicalTag_t* tag)
+{
+  assert(container);
+  assert(tag);
+  const int32_t index = HierarchicalTagArray_Find(&container->Tags, tag);
+  if (index < 0 || !HierarchicalTagArray_Reserve(&container->RemovedTags, container->RemovedTags.NumTags + 1, &container->Allocator))
+  {
+    return false;
+  }
+  HierarchicalTagArray_RemoveAtSwap(&container->Tags, (uint32_t)index);
+  HierarchicalTagContainer_RecordChange(container, tag, &container->RemovedTags, &container->AddedTags);
+  return true;
+}
+
+bool HierarchicalTagContainer_HasTag(const HierarchicalTagContainer_t* container, const HierarchicalTag_t* tag)
+{
+  assert(container);
+  assert(tag);
+  return HierarchicalTagArray_Find(&container->Tags, tag) >= 0;
+}
+
+bool HierarchicalTagContainer_HasTagMatching(const HierarchicalTagContainer_t* container, const HierarchicalTag_t* tag)
+{
+  assert(container);
+  assert(tag);
+  for (uint32_t i = 0; i < container->Tags.NumTags; ++i)
+  {
+    if (HierarchicalTag_Matches(&container->Tags.Tags[i], tag))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HierarchicalTagContainer_IsDirty(const HierarchicalTagContainer_t* container)
+{
+  assert(container);
+  return container->AddedTags.NumTags > 0 || container->RemovedTags.NumTags > 0;
+}
+
+void HierarchicalTagContainer_ClearChanges(HierarchicalTagContainer_t* container)
+{
+  assert(container);
+  // Keep the allocations around, containers tend to change again
+  container->AddedTags.NumTags = 0;
+  container->RemovedTags.NumTags = 0;
+}
+
+void HierarchicalTagEventDispatcher_Init(HierarchicalTagEventDispatcher_t* dispatcher, const HashedStringAllocator_t* allocator)
+{
+  assert(dispatcher);
+  dispatcher->Subscriptions = NULL;
+  dispatcher->NumSubscriptions = 0;
+  dispatcher->SubscriptionCapacity = 0;
+  // 0 is reserved for "invalid handle"
+  dispatcher->NextHandle = 1;
+  HierarchicalTagArray_Init(&dispatcher->BatchAdded);
+  HierarchicalTagArray_Init(&dispatcher->BatchRemoved);
+  dispatcher->ChangeStrings = NULL;
+  dispatcher->ChangeStringsCapacity = 0;
+  dispatcher->Allocator = allocator ? *allocator : *HashedStringAllocator_GetDefault();
+}
+
+void HierarchicalTagEventDispatcher_Cleanup(HierarchicalTagEventDispatcher_t* dispatcher)
+{
+  if (dispatcher)
+  {
+    HashedStringAllocator_Free(&dispatcher->Allocator, dispatcher->Subscriptions, dispatcher->SubscriptionCapacity * sizeof(HierarchicalTagSubscription_t));
+    dispatcher->Subscriptions = NULL;
+    dispatcher->NumSubscriptions = 0;
+    dispatcher->SubscriptionCapacity = 0;
+    HierarchicalTagArray_Cleanup(&dispatcher->BatchAdded, &dispatcher->Allocator);
+    HierarchicalTagArray_Cleanup(&dispatcher->BatchRemoved, &dispatcher->Allocator);
+    HashedStringAllocator_Free(&dispatcher->Allocator, (void*)dispatcher->ChangeStrings, dispatcher->ChangeStringsCapacity * sizeof(const char*));
+    dispatcher->ChangeStrings = NULL;
+    dispatcher->ChangeStringsCapacity = 0;
+  }
+}
+
+uint32_t HierarchicalTagEventDispatcher_Subscribe(
+  HierarchicalTagEventDispatcher_t* dispatcher,
+  const HierarchicalTag_t* tag,
+  bool bIncludeChildren,
+  HierarchicalTagChangedCallback callback,
+  void* userData
+)
+{
+  assert(dispatcher);
+  assert(tag);
+  assert(callback);
+
+  if (dispatcher->NumSubscriptions == dispatcher->SubscriptionCapacity)
+  {
+    const uint32_t newCapacity = dispatcher->SubscriptionCapacity ? dispatcher->SubscriptionCapacity * 2 : HIERARCHICALTAG_ARRAY_INITIALSIZE;
+    HierarchicalTagSubscription_t* newSubscriptions = (HierarchicalTagSubscription_t*)HashedStringAllocator_Alloc(&dispatcher->Allocator, newCapacity * sizeof(HierarchicalTagSubscription_t));
+    if (!newSubscriptions)
+    {
+      return 0;
+    }
+    if (dispatcher->NumSubscriptions > 0)
+    {
+      memcpy(newSubscriptions, dispatcher->Subscriptions, dispatcher->NumSubscriptions * sizeof(HierarchicalTagSubscription_t));
+    }
+    HashedStringAllocator_Free(&dispatcher->Allocator, dispatcher->Subscriptions, dispatcher->SubscriptionCapacity * sizeof(HierarchicalTagSubscription_t));
+    dispatcher->Subscriptions = newSubscriptions;
+    dispatcher->SubscriptionCapacity = newCapacity;
+  }
+
+  HierarchicalTagSubscription_t* subscription = &dispatcher->Subscriptions[dispatcher->NumSubscriptions++];
+  subscription->Tag = *tag;
+  // Interned strings never move, safe to hold on to
+  subscription->TagString = HierarchicalTag_GetString(tag);
+  subscription->TagLength = subscription->TagString ? (uint32_t)strlen(subscription->TagString) : 0;
+  subscription->bIncludeChildren = bIncludeChildren;
+  subscription->Callback = callback;
+  subscription->UserData = userData;
+  subscription->Handle = dispatcher->NextHandle++;
+  return subscription->Handle;
+}
+
+void HierarchicalTagEventDispatcher_Unsubscribe(HierarchicalTagEventDispatcher_t* dispatcher, uint32_t handle)
+{
+  assert(dispatcher);
+  for (uint32_t i = 0; i < dispatcher->NumSubscriptions; ++i)
+  {
+    if (dispatcher->Subscriptions[i].Handle == handle)
+    {
+      // Preserve order so callbacks keep firing in subscription order
+      memmove(&dispatcher->Subscriptions[i], &dispatcher->Subscriptions[i + 1], (dispatcher->NumSubscriptions - i - 1) * sizeof(HierarchicalTagSubscription_t));
+      dispatcher->NumSubscriptions--;
+      return;
+    }
+  }
+}
+
+// tagString is the tag's string, only needed (and only looked up) when a subscription includes children
+static bool HierarchicalTagSubscription_Matches(const HierarchicalTagSubscription_t* subscription, const HierarchicalTag_t* tag, const char* tagString)
+{
+  if (HierarchicalTag_Compare(tag, &subscription->Tag))
+  {
+    return true;
+  }
+  return subscription->bIncludeChildren && tagString && subscription->TagString
+    && HierarchicalTag_IsChildOfString(tagString, subscription->TagString, subscription->TagLength);
+}
+
+// Look up the strings of every change once, rather than once per subscription
+static bool HierarchicalTagEventDispatcher_ResolveChangeStrings(HierarchicalTagEventDispatcher_t* dispatcher, const HierarchicalTagContainer_t* container)
+{
+  bool bAnyIncludeChildren = false;
+  for (uint32_t s = 0; s < dispatcher->NumSubscriptions && !bAnyIncludeChildren; ++s)
+  {
+    bAnyIncludeChildren = dispatcher->Subscriptions[s].bIncludeChildren;
+  }
+  if (!bAnyIncludeChildren)
+  {
+    return true;
+  }
+
+  const uint32_t numChanges = container->AddedTags.NumTags + container->RemovedTags.NumTags;
+  if (numChanges > dispatcher->ChangeStringsCapacity)
+  {
+    const char** newChangeStrings = (const char**)HashedStringAllocator_Alloc(&dispatcher->Allocator, numChanges * sizeof(const char*));
+    if (!newChangeStrings)
+    {
+      return false;
+    }
+    HashedStringAllocator_Free(&dispatcher->Allocator, (void*)dispatcher->ChangeStrings, dispatcher->ChangeStringsCapacity * sizeof(const char*));
+    dispatcher->ChangeStrings = newChangeStrings;
+    dispatcher->ChangeStringsCapacity = numChanges;
+  }
+
+  for (uint32_t i = 0; i < container->AddedTags.NumTags; ++i)
+  {
+    dispatcher->ChangeStrings[i] = HierarchicalTag_GetString(&container->AddedTags.Tags[i]);
+  }
+  for (uint32_t i = 0; i < container->RemovedTags.NumTags; ++i)
+  {
+    dispatcher->ChangeStrings[container->AddedTags.NumTags + i] = HierarchicalTag_GetString(&container->RemovedTags.Tags[i]);
+  }
+  return true;
+}
+
+// Gather the changes matching this subscription into batch, returns false if batch couldn't grow.
+// changeStrings lines up with changes, and is only used for subscriptions including children
+static bool HierarchicalTagEventDispatcher_GatherChanges(HierarchicalTagEventDispatcher_t* dispatcher, const HierarchicalTagSubscription_t* subscription, const HierarchicalTagArray_t* changes, const char* const* changeStrings, HierarchicalTagArray_t* batch)
+{
+  batch->NumTags = 0;
+  for (uint32_t i = 0; i < changes->NumTags; ++i)
+  {
+    const char* tagString = subscription->bIncludeChildren ? changeStrings[i] : NULL;
+    if (HierarchicalTagSubscription_Matches(subscription, &changes->Tags[i], tagString) && !HierarchicalTagArray_Push(batch, &changes->Tags[i], &dispatcher->Allocator))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HierarchicalTagEventDispatcher_Flush(HierarchicalTagEventDispatcher_t* dispatcher, HierarchicalTagContainer_t* container)
+{
+  assert(dispatcher);
+  assert(container);
+  if (!HierarchicalTagContainer_IsDirty(container))
+  {
+    return true;
+  }
+
+  // A batch never holds more than every change, so reserving that up front means either every subscription fires or none do
+  if (!HierarchicalTagArray_Reserve(&dispatcher->BatchAdded, container->AddedTags.NumTags, &dispatcher->Allocator)
+    || !HierarchicalTagArray_Reserve(&dispatcher->BatchRemoved, container->RemovedTags.NumTags, &dispatcher->Allocator)
+    || !HierarchicalTagEventDispatcher_ResolveChangeStrings(dispatcher, container))
+  {
+    // Keep the container's changes so the flush can be retried
+    return false;
+  }
+
+  for (uint32_t s = 0; s < dispatcher->NumSubscriptions; ++s)
+  {
+    const HierarchicalTagSubscription_t subscription = dispatcher->Subscriptions[s];
+    const bool bGathered = HierarchicalTagEventDispatcher_GatherChanges(dispatcher, &subscription, &container->AddedTags, dispatcher->ChangeStrings, &dispatcher->BatchAdded)
+      && HierarchicalTagEventDispatcher_GatherChanges(dispatcher, &subscription, &container->RemovedTags, dispatcher->ChangeStrings + container->AddedTags.NumTags, &dispatcher->BatchRemoved);
+    // Can't fail after reserving
+    assert(bGathered);
+    (void)bGathered;
+
+    if (dispatcher->BatchAdded.NumTags > 0 || dispatcher->BatchRemoved.NumTags > 0)
+    {
+      subscription.Callback(subscription.UserData, container,
+        dispatcher->BatchAdded.Tags, dispatcher->BatchAdded.NumTags,
+        dispatcher->BatchRemoved.Tags, dispatcher->BatchRemoved.NumTags);
+    }
+  }
+
+  HierarchicalTagContainer_ClearChanges(container);
+  return true;
+}
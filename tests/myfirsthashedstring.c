@@ -1,8 +1,119 @@
 #include "HashedStringMap.h"
+#include "HashedStringHash.h"
+#include "HashedStringSharedRegistry.h"
+#include "HierarchicalTagContainer.h"
+#include "StringUtil.h"
 #include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SHARED_REGISTRY_TEST_WORKERS 4
+
+static const char* SharedRegistryTestTags[] = { "Status.Stunned", "Status.Burning", "Ability.Fireball", "Ability.Fireball.Cooldown" };
+#define SHARED_REGISTRY_TEST_NUM_TAGS (sizeof(SharedRegistryTestTags) / sizeof(SharedRegistryTestTags[0]))
+
+// Fork several workers which all intern the same tags into one shared registry, then check they got identical handles.
+// Must run before anything else creates a HashedString so the workers start with no local map
+static void TestSharedRegistry(void)
+{
+  char registryName[64];
+  snprintf(registryName, sizeof(registryName), "/htags-test-%d", (int)getpid());
+  HashedStringSharedRegistry_t* registry = HashedStringSharedRegistry_Create(registryName, 64 * 1024, 64, NULL);
+  if (!registry)
+  {
+    printf("Shared registry: failed to create %s\n", registryName);
+    return;
+  }
+
+  int pipes[SHARED_REGISTRY_TEST_WORKERS][2];
+  for (int w = 0; w < SHARED_REGISTRY_TEST_WORKERS; ++w)
+  {
+    if (pipe(pipes[w]) != 0)
+    {
+      printf("Shared registry: pipe failed\n");
+      return;
+    }
+    if (fork() == 0)
+    {
+      // Worker, intern every tag (in a different order per worker) and send the handles back in tag order
+      close(pipes[w][0]);
+      HashedString_SetSharedRegistry(registry);
+      HString handles[SHARED_REGISTRY_TEST_NUM_TAGS];
+      for (size_t t = 0; t < SHARED_REGISTRY_TEST_NUM_TAGS; ++t)
+      {
+        const size_t tagIndex = (t + w) % SHARED_REGISTRY_TEST_NUM_TAGS;
+        handles[tagIndex] = HashedString_Create(SharedRegistryTestTags[tagIndex]);
+      }
+      bool bStringsMatch = true;
+      for (size_t t = 0; t < SHARED_REGISTRY_TEST_NUM_TAGS; ++t)
+      {
+        bStringsMatch &= strcmp(HashedString_GetString(&handles[t]), SharedRegistryTestTags[t]) == 0;
+      }
+      const ssize_t written = write(pipes[w][1], handles, sizeof(handles));
+      _exit(bStringsMatch && written == (ssize_t)sizeof(handles) ? 0 : 1);
+    }
+    close(pipes[w][1]);
+  }
+
+  HString workerHandles[SHARED_REGISTRY_TEST_WORKERS][SHARED_REGISTRY_TEST_NUM_TAGS];
+  bool bWorkersSucceeded = true;
+  for (int w = 0; w < SHARED_REGISTRY_TEST_WORKERS; ++w)
+  {
+    bWorkersSucceeded &= read(pipes[w][0], workerHandles[w], sizeof(workerHandles[w])) == (ssize_t)sizeof(workerHandles[w]);
+    close(pipes[w][0]);
+  }
+  for (int w = 0; w < SHARED_REGISTRY_TEST_WORKERS; ++w)
+  {
+    int status = 0;
+    wait(&status);
+    bWorkersSucceeded &= WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+
+  bool bHandlesMatch = true;
+  for (int w = 1; w < SHARED_REGISTRY_TEST_WORKERS; ++w)
+  {
+    for (size_t t = 0; t < SHARED_REGISTRY_TEST_NUM_TAGS; ++t)
+    {
+      bHandlesMatch &= HashedString_Compare_WithSensitivity(&workerHandles[0][t], &workerHandles[w][t], HSCS_Sensitive);
+    }
+  }
+
+  printf("Shared registry: workers succeeded: %d, handles match: %d, elements: %u\n", bWorkersSucceeded, bHandlesMatch, HashedStringSharedRegistry_GetNumElements(registry));
+
+  HashedStringSharedRegistry_Close(registry);
+  HashedStringSharedRegistry_Unlink(registryName);
+}
+#endif // HASHEDSTRING_HAS_SHARED_REGISTRY
+
+static void OnStatusChanged(
+  void* userData,
+  const HierarchicalTagContainer_t* container,
+  const HierarchicalTag_t* addedTags, uint32_t numAdded,
+  const HierarchicalTag_t* removedTags, uint32_t numRemoved
+)
+{
+  printf("Status changed (version %u):", container->Version);
+  for (uint32_t i = 0; i < numAdded; ++i)
+  {
+    printf(" +%s", HierarchicalTag_GetString(&addedTags[i]));
+  }
+  for (uint32_t i = 0; i < numRemoved; ++i)
+  {
+    printf(" -%s", HierarchicalTag_GetString(&removedTags[i]));
+  }
+  printf("\n");
+}
 
 int main(int argc, const char** argv)
 {
+#if HASHEDSTRING_HAS_SHARED_REGISTRY
+  TestSharedRegistry();
+#endif
+
   HString myFirstString = HashedString_Create("MyFirstString");
   const char* myStringReturned = HashedString_GetString(&myFirstString);
 
@@ -19,5 +130,155 @@ int main(int argc, const char** argv)
 
   printf("Comparing myFirstString with myFirstStringButLowercase: %d\n", HashedString_Compare_WithSensitivity(&myFirstString, &myFirstStringButLowercase, HSCS_Insensitive));
 
+  HString apple = HashedString_Create("Apple");
+  HString banana = HashedString_Create("banana");
+  HString applePie = HashedString_Create("ApplePieWithCream");
+  HString applePies = HashedString_Create("ApplePieWithCustard");
+
+  printf("Lexically comparing Apple with banana: %d\n", HashedString_CompareLexical(&apple, &banana));
+  printf("Lexically comparing ApplePieWithCustard with ApplePieWithCream: %d\n", HashedString_CompareLexical(&applePies, &applePie));
+  printf("Lexically comparing myFirstString with myFirstStringButLowercase: %d\n", HashedString_CompareLexical(&myFirstString, &myFirstStringButLowercase));
+  printf("Lexically comparing myFirstString with myFirstStringButLowercase, case-insensitive: %d\n", HashedString_CompareLexical_WithSensitivity(&myFirstString, &myFirstStringButLowercase, HSCS_Insensitive));
+  printf("Lexically comparing banana with MySecondString, case-insensitive: %d\n", HashedString_CompareLexical_WithSensitivity(&banana, &mySecondString, HSCS_Insensitive));
+
+  const HashedString_t nullString = HashedString_Create(NULL);
+  const HashedString_t otherNullString = HashedString_Create(NULL);
+  printf("myFirstString is valid: %d, NULL string is valid: %d, NULL strings compare equal: %d\n", HashedString_IsValid(&myFirstString), HashedString_IsValid(&nullString), HashedString_Compare_WithSensitivity(&nullString, &otherNullString, HSCS_Sensitive));
+
+  printf("Hash collisions detected: %u\n", HashedString_GetNumCollisions());
+
+  // Every kernel must produce the same hash, they only differ in speed
+  uint32_t numBackends = 0;
+  const HashedStringHashBackend_t* backends = HashedStringHash_GetBackends(&numBackends);
+  const hsHash_t expectedHash = HashedStringHash_Hash(&backends[0], "Status.Stunned", 15, 42);
+  bool bBackendsAgree = true;
+  for (uint32_t b = 1; b < numBackends; ++b)
+  {
+    bBackendsAgree &= hsHash_Equal(HashedStringHash_Hash(&backends[b], "Status.Stunned", 15, 42), expectedHash);
+  }
+  const HashedStringHashInfo_t hashInfo = HashedString_GetHashInfo();
+  printf("Best hash backend: %s, %u backends agree: %d, algorithm %u, seed %llu\n", HashedStringHash_GetBestBackend()->Name, numBackends, bBackendsAgree, hashInfo.Algorithm, (unsigned long long)hashInfo.Seed);
+
+  // A map hashes with its own seed
+  HashedStringMap_t* seededMap = HashedStringMap_Create(4);
+  HashedStringMap_SetHashing(seededMap, HashedStringHash_GetBestBackend(), 42);
+  const HashedStringHashInfo_t seededHashInfo = HashedStringMap_GetHashInfo(seededMap);
+  printf("Seeded map hashes with seed %llu: %d\n", (unsigned long long)seededHashInfo.Seed, hsHash_Equal(HashedStringMap_HashString(seededMap, "Status.Stunned", 15, 0), expectedHash));
+  HashedStringMap_Destroy(seededMap);
+
+  HashedStringTrackingAllocator_t trackingAllocator;
+  HashedStringTrackingAllocator_Init(&trackingAllocator, NULL);
+  HashedStringAllocator_t tracked = HashedStringTrackingAllocator_GetAllocator(&trackingAllocator);
+
+  HashedStringMap_t* trackedMap = HashedStringMap_CreateWithAllocator(4, &tracked);
+  HashedStringMap_FindOrAddVerified(trackedMap, apple.Hash, 0, "Apple", 5, NULL);
+  HashedStringMap_FindOrAddVerified(trackedMap, banana.Hash, 0, "banana", 6, NULL);
+  printf("Tracked map bytes: %zu in %u allocations\n", trackingAllocator.BytesAllocated, trackingAllocator.NumAllocations);
+  HashedStringMap_Destroy(trackedMap);
+  printf("Tracked map bytes after destroy: %zu in %u allocations\n", trackingAllocator.BytesAllocated, trackingAllocator.NumAllocations);
+
+  // Collisions, forced by adding different strings under the same hash
+  HashedStringMap_t collisionMap;
+  HashedStringMap_Init(&collisionMap, 4);
+  const hsHash_t sharedHash = apple.Hash;
+  bool bCollision = false;
+  const HashedStringEntry_t* firstEntry = HashedStringMap_FindOrAddVerified(&collisionMap, sharedHash, 0, "Apple", 5, &bCollision);
+  assert(firstEntry && !bCollision);
+  const HashedStringEntry_t* collidingEntry = HashedStringMap_FindOrAddVerified(&collisionMap, sharedHash, 0, "Orange", 6, &bCollision);
+  assert(!collidingEntry && bCollision);
+  const HashedStringEntry_t* keptEntry = HashedStringMap_FindOrAddVerified(&collisionMap, sharedHash, 0, "Apple", 5, &bCollision);
+  assert(keptEntry == firstEntry && !bCollision && strcmp(keptEntry->String, "Apple") == 0);
+  assert(collisionMap.NumCollisions == 0);
+  // The colliding string lands under its re-hash, counted once no matter how often it's looked up again
+  const hsHash_t rehashedHash = HashedStringMap_HashString(&collisionMap, "Orange", 7, 1);
+  const HashedStringEntry_t* rehashedEntry = HashedStringMap_FindOrAddVerified(&collisionMap, rehashedHash, 1, "Orange", 6, &bCollision);
+  assert(rehashedEntry && !bCollision && collisionMap.NumCollisions == 1);
+  const HashedStringEntry_t* rehashedAgain = HashedStringMap_FindOrAddVerified(&collisionMap, rehashedHash, 1, "Orange", 6, &bCollision);
+  assert(rehashedAgain == rehashedEntry && collisionMap.NumCollisions == 1);
+  // Only stringLength characters are stored, the buffer needn't be terminated there
+  const char applesauce[] = { 'A', 'p', 'p', 'l', 'e', 's', 'a', 'u', 'c', 'e' };
+  const HashedStringEntry_t* prefixEntry = HashedStringMap_FindOrAddVerified(&collisionMap, banana.Hash, 0, applesauce, 5, NULL);
+  assert(prefixEntry && strcmp(prefixEntry->String, "Apple") == 0);
+  assert(!HashedStringMap_FindOrAddVerified(&collisionMap, mySecondString.Hash, 0, NULL, 0, &bCollision) && !bCollision);
+  printf("Forced collision: rejected %d, first entry kept %d, collisions counted %u\n", collidingEntry == NULL, keptEntry == firstEntry, collisionMap.NumCollisions);
+  HashedStringMap_Cleanup(&collisionMap);
+
+  // Caller-owned map, Cleanup must leave the map itself alone
+  HashedStringMap_t stackMap;
+  HashedStringMap_InitWithAllocator(&stackMap, 4, &tracked);
+  HashedStringMap_FindOrAddVerified(&stackMap, apple.Hash, 0, "Apple", 5, NULL);
+  HashedStringMap_Cleanup(&stackMap);
+  printf("Tracked stack map bytes after cleanup: %zu\n", trackingAllocator.BytesAllocated);
+
+  uint8_t scratchBuffer[1024];
+  HashedStringLinearAllocator_t linearAllocator;
+  HashedStringLinearAllocator_Init(&linearAllocator, scratchBuffer, sizeof(scratchBuffer));
+  HashedStringAllocator_t linear = HashedStringLinearAllocator_GetAllocator(&linearAllocator);
+
+  char** explodedStrings = NULL;
+  const int32_t numExplodedStrings = ExplodeString_WithAllocator(&linear, "A.B.C", ".", &explodedStrings);
+  printf("Exploded A.B.C into %d strings:", numExplodedStrings);
+  for (int32_t i = 0; i < numExplodedStrings; ++i)
+  {
+    printf(" %s", explodedStrings[i]);
+  }
+  printf("\n");
+  HashedStringLinearAllocator_Reset(&linearAllocator);
+
+  // Multi-character seperators split on the whole seperator
+  const int32_t numScopedStrings = ExplodeString_WithAllocator(&linear, "Ability::Fire::Ball", "::", &explodedStrings);
+  printf("Exploded Ability::Fire::Ball into %d strings:", numScopedStrings);
+  for (int32_t i = 0; i < numScopedStrings; ++i)
+  {
+    printf(" %s", explodedStrings[i]);
+  }
+  printf("\n");
+  HashedStringLinearAllocator_Reset(&linearAllocator);
+
+  HTag status = HierarchicalTag_Create("Status");
+  HTag stunned = HierarchicalTag_Create("Status.Stunned");
+  HTag burning = HierarchicalTag_Create("Status.Burning");
+  HTag statusEffect = HierarchicalTag_Create("StatusEffect");
+  printf("Status.Stunned is child of Status: %d, StatusEffect is child of Status: %d\n", HierarchicalTag_IsChildOf(&stunned, &status), HierarchicalTag_IsChildOf(&statusEffect, &status));
+
+  HierarchicalTagContainer_t container;
+  HierarchicalTagContainer_Init(&container, NULL);
+  HierarchicalTagEventDispatcher_t dispatcher;
+  HierarchicalTagEventDispatcher_Init(&dispatcher, NULL);
+  HierarchicalTagEventDispatcher_Subscribe(&dispatcher, &status, true, OnStatusChanged, NULL);
+
+  HierarchicalTagContainer_AddTag(&container, &stunned);
+  HierarchicalTagContainer_AddTag(&container, &burning);
+  HierarchicalTagContainer_AddTag(&container, &statusEffect);
+  HierarchicalTagEventDispatcher_Flush(&dispatcher, &container);
+
+  // Add then remove within one batch cancels out, only the Stunned removal should be reported
+  HierarchicalTagContainer_RemoveTag(&container, &stunned);
+  HierarchicalTagContainer_RemoveTag(&container, &burning);
+  HierarchicalTagContainer_AddTag(&container, &burning);
+  HierarchicalTagEventDispatcher_Flush(&dispatcher, &container);
+  printf("Container dirty after flush: %d\n", HierarchicalTagContainer_IsDirty(&container));
+
+
+  // A dispatcher that can't allocate its batches fires nothing and leaves the changes for a retry
+  uint8_t dispatcherBuffer[512];
+  HashedStringLinearAllocator_t dispatcherLinearAllocator;
+  HashedStringLinearAllocator_Init(&dispatcherLinearAllocator, dispatcherBuffer, sizeof(dispatcherBuffer));
+  HashedStringAllocator_t dispatcherLinear = HashedStringLinearAllocator_GetAllocator(&dispatcherLinearAllocator);
+  HierarchicalTagEventDispatcher_t starvedDispatcher;
+  HierarchicalTagEventDispatcher_Init(&starvedDispatcher, &dispatcherLinear);
+  HierarchicalTagEventDispatcher_Subscribe(&starvedDispatcher, &status, true, OnStatusChanged, NULL);
+  HashedStringAllocator_Alloc(&dispatcherLinear, dispatcherLinearAllocator.Capacity - dispatcherLinearAllocator.Offset);
+  HierarchicalTagContainer_RemoveTag(&container, &burning);
+  const bool bStarvedFlushed = HierarchicalTagEventDispatcher_Flush(&starvedDispatcher, &container);
+  assert(!bStarvedFlushed && HierarchicalTagContainer_IsDirty(&container));
+  const bool bFlushed = HierarchicalTagEventDispatcher_Flush(&dispatcher, &container);
+  assert(bFlushed && !HierarchicalTagContainer_IsDirty(&container));
+  printf("Starved dispatcher flushed: %d, changes kept for retry: %d\n", bStarvedFlushed, bFlushed);
+  HierarchicalTagEventDispatcher_Cleanup(&starvedDispatcher);
+
+  HierarchicalTagEventDispatcher_Cleanup(&dispatcher);
+  HierarchicalTagContainer_Cleanup(&container);
+
   return 0;
 }